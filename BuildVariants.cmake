@@ -0,0 +1,137 @@
+# MODULE:   BuildVariants
+#
+# Build types and profile guided optimisation for the whole tree.
+#
+#   Release          -O2 -DNDEBUG, like the Tup release config.
+#   RelWithDebInfo   -O2 -g with frame pointers, for perf and other profilers
+#                    that walk the stack.
+#   Debug            -O0 -g.
+#
+# These replace the defaults of CMake only. Flags given on the command line,
+# like -DCMAKE_CXX_FLAGS_RELEASE=..., or edited in the cache are kept.
+#
+# PGO is independent of the build type:
+#
+#   cmake -DCMAKE_BUILD_TYPE=Release -DPGO=GENERATE <source>
+#   cmake --build . --target train
+#   cmake -DPGO=USE .
+#   cmake --build .
+#
+# The profiles go to PGO_PROFILE_DIR. To use them from another build
+# directory, point PGO_PROFILE_DIR of that build at the same place.
+#
+# PROVIDES:
+#   add_training_run(<name> <target> [ARGS <arg>...] [INPUT <file>])
+#
+#       Adds a run of <target> to the `train` target, which runs the
+#       representative workload of every program. With PGO=GENERATE this is
+#       what produces the profiles, but it can be used for any other
+#       profiling too. The output of the program is discarded.
+
+if (NOT CMAKE_BUILD_TYPE AND NOT CMAKE_CONFIGURATION_TYPES)
+    set(CMAKE_BUILD_TYPE Release CACHE STRING
+        "Debug, Release or RelWithDebInfo" FORCE)
+endif()
+
+include(CMakeParseArguments)
+include(CheckCXXCompilerFlag)
+
+# Sets CMAKE_CXX_FLAGS_<config> to flags if it still has the default of
+# CMake, which is the _INIT variable without the leading space.
+function(set_build_type_flags config flags)
+    set(variable CMAKE_CXX_FLAGS_${config})
+    string(STRIP "${${variable}_INIT}" default)
+    if ("${${variable}}" STREQUAL "${default}")
+        set(${variable} "${flags}" PARENT_SCOPE)
+    endif()
+endfunction()
+
+set(RELWITHDEBINFO_FLAGS "-O2 -g -DNDEBUG -fno-omit-frame-pointer")
+check_cxx_compiler_flag(-mno-omit-leaf-frame-pointer
+    HAVE_NO_OMIT_LEAF_FRAME_POINTER)
+if (HAVE_NO_OMIT_LEAF_FRAME_POINTER)
+    set(RELWITHDEBINFO_FLAGS
+        "${RELWITHDEBINFO_FLAGS} -mno-omit-leaf-frame-pointer")
+endif()
+
+# -g is in the flags of the build types and not in CMAKE_CXX_FLAGS, so that
+# Release builds have no debug info.
+set_build_type_flags(DEBUG "-O0 -g")
+set_build_type_flags(RELEASE "-O2 -DNDEBUG")
+set_build_type_flags(RELWITHDEBINFO "${RELWITHDEBINFO_FLAGS}")
+
+set(PGO OFF CACHE STRING "Profile guided optimisation: OFF, GENERATE or USE")
+set_property(CACHE PGO PROPERTY STRINGS OFF GENERATE USE)
+set(PGO_PROFILE_DIR ${CMAKE_BINARY_DIR}/pgo CACHE PATH
+    "Where PGO=GENERATE writes and PGO=USE reads the profiles")
+
+set(PGO_FLAGS "")
+set(PGO_MERGE_COMMAND "")
+
+if (PGO STREQUAL "GENERATE" OR PGO STREQUAL "USE")
+    if (CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+        get_filename_component(COMPILER_DIR ${CMAKE_CXX_COMPILER} DIRECTORY)
+        find_program(LLVM_PROFDATA NAMES llvm-profdata HINTS ${COMPILER_DIR})
+        if (NOT LLVM_PROFDATA)
+            message(FATAL_ERROR "PGO with clang needs llvm-profdata")
+        endif()
+        set(PGO_PROFILE_DATA ${PGO_PROFILE_DIR}/default.profdata)
+        if (PGO STREQUAL "GENERATE")
+            set(PGO_FLAGS
+                "-fprofile-instr-generate=${PGO_PROFILE_DIR}/%m-%p.profraw")
+            set(PGO_MERGE_COMMAND
+                COMMAND ${CMAKE_COMMAND} -DLLVM_PROFDATA=${LLVM_PROFDATA}
+                    -DPROFILE_DIR=${PGO_PROFILE_DIR}
+                    -P ${CMAKE_SOURCE_DIR}/MergeProfiles.cmake)
+        else()
+            set(PGO_FLAGS "-fprofile-instr-use=${PGO_PROFILE_DATA}")
+        endif()
+    elseif (CMAKE_COMPILER_IS_GNUCXX)
+        # Strip the build directory from the profile names, so that a
+        # different build directory can use them.
+        check_cxx_compiler_flag(-fprofile-prefix-path=/
+            HAVE_PROFILE_PREFIX_PATH)
+        if (HAVE_PROFILE_PREFIX_PATH)
+            set(PGO_FLAGS "-fprofile-prefix-path=${CMAKE_BINARY_DIR}")
+        endif()
+        if (PGO STREQUAL "GENERATE")
+            set(PGO_FLAGS "${PGO_FLAGS} -fprofile-generate=${PGO_PROFILE_DIR}")
+            set(PGO_FLAGS "${PGO_FLAGS} -fprofile-update=atomic")
+        else()
+            set(PGO_FLAGS "${PGO_FLAGS} -fprofile-use=${PGO_PROFILE_DIR}")
+            set(PGO_FLAGS "${PGO_FLAGS} -fprofile-correction")
+            set(PGO_FLAGS "${PGO_FLAGS} -Wno-missing-profile")
+        endif()
+    else()
+        message(FATAL_ERROR "PGO is not supported with ${CMAKE_CXX_COMPILER_ID}")
+    endif()
+
+    set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} ${PGO_FLAGS}")
+    set(CMAKE_EXE_LINKER_FLAGS "${CMAKE_EXE_LINKER_FLAGS} ${PGO_FLAGS}")
+    message(STATUS "PGO ${PGO} with profiles in ${PGO_PROFILE_DIR}")
+elseif (NOT PGO STREQUAL "OFF")
+    message(FATAL_ERROR "PGO must be OFF, GENERATE or USE, not ${PGO}")
+endif()
+
+add_custom_target(train
+    ${PGO_MERGE_COMMAND}
+    COMMENT "Running the training workloads"
+    VERBATIM)
+
+function(add_training_run name target)
+    cmake_parse_arguments(TRAINING "" "INPUT" "ARGS" ${ARGN})
+    string(REPLACE ";" " " TRAINING_COMMAND_LINE "${TRAINING_ARGS}")
+    add_custom_target(train_${name}
+        COMMAND ${CMAKE_COMMAND} -E make_directory ${PGO_PROFILE_DIR}
+        COMMAND ${CMAKE_COMMAND}
+            -DNAME=${name}
+            -DPROGRAM=$<TARGET_FILE:${target}>
+            "-DARGS=${TRAINING_ARGS}"
+            -DINPUT=${TRAINING_INPUT}
+            -P ${CMAKE_SOURCE_DIR}/RunTraining.cmake
+        WORKING_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR}
+        COMMENT "Training ${target} ${TRAINING_COMMAND_LINE}"
+        VERBATIM)
+    add_dependencies(train_${name} ${target})
+    add_dependencies(train train_${name})
+endfunction()
@@ -0,0 +1,18 @@
+# Merges the raw clang profiles written by the training runs into the
+# default.profdata that PGO=USE reads.
+#
+#   cmake -DLLVM_PROFDATA=<llvm-profdata> -DPROFILE_DIR=<dir>
+#         -P MergeProfiles.cmake
+
+file(GLOB PROFILES ${PROFILE_DIR}/*.profraw)
+if (NOT PROFILES)
+    message(FATAL_ERROR "There are no profiles in ${PROFILE_DIR}")
+endif()
+
+execute_process(COMMAND ${LLVM_PROFDATA} merge
+    -output=${PROFILE_DIR}/default.profdata ${PROFILES}
+    RESULT_VARIABLE RESULT)
+
+if (NOT RESULT EQUAL 0)
+    message(FATAL_ERROR "llvm-profdata failed: ${RESULT}")
+endif()
@@ -0,0 +1,18 @@
+# Runs one training workload, see add_training_run() in BuildVariants.cmake.
+#
+#   cmake -DNAME=<name> -DPROGRAM=<program> -DARGS=<arg;...> [-DINPUT=<file>]
+#         -P RunTraining.cmake
+
+if (INPUT)
+    set(INPUT_ARGUMENT INPUT_FILE ${INPUT})
+endif()
+
+execute_process(COMMAND ${PROGRAM} ${ARGS}
+    ${INPUT_ARGUMENT}
+    OUTPUT_FILE ${NAME}.training.out
+    ERROR_FILE ${NAME}.training.err
+    RESULT_VARIABLE RESULT)
+
+if (NOT RESULT EQUAL 0)
+    message(FATAL_ERROR "${PROGRAM} ${ARGS} failed: ${RESULT}")
+endif()
@@ -0,0 +1,9 @@
+#ifndef BENCHMARK_ALLOCATIONCOUNTER_HPP
+#define BENCHMARK_ALLOCATIONCOUNTER_HPP
+
+#include <cstddef>
+
+// Number of calls to the global operator new since the program started.
+std::size_t allocationCount();
+
+#endif // BENCHMARK_ALLOCATIONCOUNTER_HPP
@@ -0,0 +1,117 @@
+#include <Game.hpp>
+#include <GameInfo.hpp>
+#include <LowerBound.hpp>
+#include <Solver.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#ifndef CREEP_DATA_DIR
+#define CREEP_DATA_DIR "../creep"
+#endif
+
+namespace {
+
+std::ifstream openDataFile(const std::string& name) {
+    std::ifstream file{std::string{CREEP_DATA_DIR} + "/" + name};
+    if (!file) {
+        throw std::runtime_error{"Cannot open " + name};
+    }
+    return file;
+}
+
+GameInfo loadTestMap() {
+    auto file = openDataFile("test1.map");
+    return loadGameInfo(file);
+}
+
+// test1.map with the commands of test1.in.
+Game loadTestGame() {
+    Game game{loadTestMap()};
+    auto file = openDataFile("test1.in");
+    int numCommands;
+    file >> numCommands;
+    for (int i = 0; i < numCommands; ++i) {
+        Command command;
+        file >> command.time >> command.type >> command.id >>
+                command.position.x >> command.position.y;
+        game.addCommand(command);
+    }
+    return game;
+}
+
+// The whole game of test1.in, one tick at a time.
+void gameTick(benchmark::State& state) {
+    const Game initialGame = loadTestGame();
+    std::size_t ticks = 0;
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        Game game = initialGame;
+        state.ResumeTiming();
+        while (game.canContinue()) {
+            game.tick();
+            ++ticks;
+        }
+        benchmark::DoNotOptimize(game.getStatus().getFloorsRemaining());
+    }
+    state.SetItemsProcessed(ticks);
+}
+BENCHMARK(gameTick)->Unit(benchmark::kMillisecond);
+
+// Heuristics are {timeMultiplier, distanceSquareMultiplier,
+// spreadRadiusMultiplier}, as the arguments divided by 10.
+void solve(benchmark::State& state) {
+    const Game game{loadTestMap()};
+    Heuristics heuristics{state.range(0) / 10.0f, state.range(1) / 10.0f,
+            state.range(2) / 10.0f};
+    int time = 0;
+    while (state.KeepRunning()) {
+        Solution solution = findSolution(game, heuristics);
+        time = solution.time;
+    }
+    state.counters["gameTime"] = time;
+}
+BENCHMARK(solve)->Args({0, -10, 10})->Args({-10, -10, 10})
+        ->Unit(benchmark::kMillisecond);
+
+// The same with the result of the other heuristics as the incumbent, so the
+// lower bound is checked during the search and may stop it.
+void solveWithIncumbent(benchmark::State& state) {
+    const Game game{loadTestMap()};
+    Heuristics heuristics{state.range(0) / 10.0f, state.range(1) / 10.0f,
+            state.range(2) / 10.0f};
+    Heuristics other{state.range(0) == 0 ? -1.0f : 0.0f, -1.0f, 1.0f};
+    Solution best = findSolution(game, other);
+    Incumbent incumbent;
+    incumbent.update(best.floorsRemaining, best.time);
+    int aborted = 0;
+    while (state.KeepRunning()) {
+        Solution solution = findSolution(game, heuristics, nullptr,
+                &incumbent);
+        aborted = solution.aborted;
+    }
+    state.counters["aborted"] = aborted;
+}
+BENCHMARK(solveWithIncumbent)->Args({0, -10, 10})->Args({-10, -10, 10})
+        ->Unit(benchmark::kMillisecond);
+
+// One lower bound in the middle of the game of test1.in.
+void lowerBound(benchmark::State& state) {
+    Game game = loadTestGame();
+    while (game.canContinue() &&
+            game.getStatus().getTime() < game.getTimeLimit() / 2) {
+        game.tick();
+    }
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(calculateLowerBound(game.getStatus(),
+                game.getTimeLimit()));
+    }
+}
+BENCHMARK(lowerBound)->Unit(benchmark::kMicrosecond);
+
+} // unnamed namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,99 @@
+#include "AllocationCounter.hpp"
+
+#include <Constants.hpp>
+#include <GameInfo.hpp>
+#include <Spread.hpp>
+#include <Status.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+namespace {
+
+// Open square map surrounded by walls, with the hatchery in the corner.
+GameInfo createGameInfo(int size) {
+    GameInfo gameInfo;
+    gameInfo.table = Table{static_cast<std::size_t>(size),
+            static_cast<std::size_t>(size), MapElement::Floor};
+    for (Point p : matrixRange(gameInfo.table)) {
+        if (p.x == 0 || p.y == 0 || p.x == size - 1 || p.y == size - 1) {
+            gameInfo.table[p] = MapElement::Wall;
+        }
+    }
+    gameInfo.hatcheryPosition = Point{2, 2};
+    gameInfo.timeLimit = 500;
+    return gameInfo;
+}
+
+// A status with a tumor at the edge of the creep of the hatchery, so that
+// there is still creep to spread.
+Status createStatus(int size) {
+    Status status{createGameInfo(size)};
+    Point position = status.getTumors()[0].position +
+            p10 * (rules::hatcherySize - rules::hatcheryCenterOffset);
+    while (status.isCreep(position + p10)) {
+        position += p10;
+    }
+    status.addTumorFromQueen(status.getQueens()[0].id, position);
+    for (int i = 0; i < 10; ++i) {
+        status.tick();
+    }
+    return status;
+}
+
+// How Status::spreadCreepFrom() looked up the candidates before.
+void spreadCandidatesVector(benchmark::State& state) {
+    Status status = createStatus(state.range(0));
+    Point center = status.getTumors().back().position;
+    std::size_t allocations = allocationCount();
+    while (state.KeepRunning()) {
+        auto candidates = findSpreadArea(getMax(status), center,
+                rules::creepSpreadRadius,
+                getPredicate(status, &Status::isCreepCandidate));
+        benchmark::DoNotOptimize(candidates.data());
+    }
+    state.counters["allocs/call"] = static_cast<double>(
+            allocationCount() - allocations) / state.iterations();
+}
+BENCHMARK(spreadCandidatesVector)->Arg(36)->Arg(64);
+
+void spreadCandidatesBuffer(benchmark::State& state) {
+    Status status = createStatus(state.range(0));
+    Point center = status.getTumors().back().position;
+    std::size_t allocations = allocationCount();
+    while (state.KeepRunning()) {
+        SpreadArea candidates;
+        findSpreadArea(getMax(status), center, rules::creepSpreadRadius,
+                getPredicate(status, &Status::isCreepCandidate), candidates);
+        benchmark::DoNotOptimize(candidates.data());
+    }
+    state.counters["allocs/call"] = static_cast<double>(
+            allocationCount() - allocations) / state.iterations();
+}
+BENCHMARK(spreadCandidatesBuffer)->Arg(36)->Arg(64);
+
+void statusTick(benchmark::State& state) {
+    const Status initialStatus = createStatus(state.range(0));
+    std::size_t ticks = 0;
+    std::size_t allocations = 0;
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        Status status = initialStatus;
+        std::size_t allocationsBefore = allocationCount();
+        state.ResumeTiming();
+        for (int i = 0; i < 100 && status.getFloorsRemaining() != 0; ++i) {
+            status.tick();
+            ++ticks;
+        }
+        state.PauseTiming();
+        allocations += allocationCount() - allocationsBefore;
+        state.ResumeTiming();
+    }
+    state.counters["allocs/tick"] = static_cast<double>(allocations) / ticks;
+}
+BENCHMARK(statusTick)->Arg(36)->Arg(64);
+
+} // unnamed namespace
+
+BENCHMARK_MAIN();
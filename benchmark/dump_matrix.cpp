@@ -0,0 +1,86 @@
+#include <DumperFunctions.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <fstream>
+
+namespace {
+
+// How dumpMatrix() looked before.
+template<typename T, typename Converter = ToString>
+void dumpMatrixPerCell(std::ostream& file, const Matrix<T> table,
+        const Converter& converter = Converter{}) {
+    Matrix<std::string> txts(table.width(), table.height());
+    size_t maxlen = 0;
+    for (Point  p: matrixRange(table)) {
+        txts[p] = converter(table[p]);
+        maxlen = std::max(maxlen, txts[p].size());
+    }
+    ++maxlen;
+    Point p;
+    for (p.y = 0; p.y < static_cast<int>(table.height()); p.y++) {
+        for (p.x = 0; p.x < static_cast<int>(table.width()); p.x++) {
+            if (p.x % 10 == 0 || p.y % 10 == 0) {
+                file << "\e[0;31m";
+            } else if (p.x % 5 == 0 || p.y % 5 == 0) {
+                file << "\e[0;33m";
+            }
+            file.width(maxlen);
+            file << txts[p];
+            file.width(0);
+            if (p.x % 5 == 0 || p.y % 5 == 0) {
+                file << "\e[0m";
+            }
+        }
+        file << std::endl;
+    }
+    file << std::endl;
+}
+
+Matrix<int> createMatrix(std::size_t size) {
+    Matrix<int> result{size, size};
+    int i = 0;
+    for (int& value : result) {
+        value = i++ % 5;
+    }
+    return result;
+}
+
+void dumpPerCell(benchmark::State& state) {
+    const auto matrix = createMatrix(state.range(0));
+    std::ofstream file{"/dev/null"};
+    while (state.KeepRunning()) {
+        dumpMatrixPerCell(file, matrix);
+    }
+    state.SetItemsProcessed(state.iterations() * matrix.size());
+}
+BENCHMARK(dumpPerCell)->Arg(1000)->Arg(3300);
+
+void dumpBuffered(benchmark::State& state) {
+    const auto matrix = createMatrix(state.range(0));
+    std::ofstream file{"/dev/null"};
+    DumpOptions options;
+    options.colour = state.range(1) != 0;
+    while (state.KeepRunning()) {
+        dumpMatrix(file, matrix, options);
+    }
+    state.SetItemsProcessed(state.iterations() * matrix.size());
+}
+BENCHMARK(dumpBuffered)->Args({1000, 1})->Args({3300, 1})->Args({3300, 0});
+
+void dumpDownsampled(benchmark::State& state) {
+    const auto matrix = createMatrix(state.range(0));
+    std::ofstream file{"/dev/null"};
+    DumpOptions options;
+    options.maxWidth = 100;
+    options.maxHeight = 100;
+    while (state.KeepRunning()) {
+        dumpMatrix(file, matrix, options);
+    }
+    state.SetItemsProcessed(state.iterations() * matrix.size());
+}
+BENCHMARK(dumpDownsampled)->Arg(3300);
+
+} // unnamed namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,84 @@
+#include <MatrixIO.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace {
+
+// A lakotelep-like board: heights 1-4 separated by spaces.
+std::string createNumberGrid(std::size_t size) {
+    std::mt19937 generator{42};
+    std::string result;
+    for (std::size_t y = 0; y < size; ++y) {
+        for (std::size_t x = 0; x < size; ++x) {
+            result += static_cast<char>('1' + generator() % 4);
+            result += x + 1 == size ? '\n' : ' ';
+        }
+    }
+    return result;
+}
+
+// A creep-like map.
+std::string createCharacterGrid(std::size_t size) {
+    std::mt19937 generator{42};
+    std::string result;
+    for (std::size_t y = 0; y < size; ++y) {
+        for (std::size_t x = 0; x < size; ++x) {
+            result += generator() % 8 == 0 ? '#' : '.';
+        }
+        result += '\n';
+    }
+    return result;
+}
+
+void loadNumbers(benchmark::State& state) {
+    const std::string text = createNumberGrid(state.range(0));
+    while (state.KeepRunning()) {
+        std::istringstream ss{text};
+        auto matrix = loadMatrix<int>(ss);
+        benchmark::DoNotOptimize(matrix[p00]);
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(loadNumbers)->Arg(1000)->Arg(3300);
+
+void readNumbers(benchmark::State& state) {
+    const std::string text = createNumberGrid(state.range(0));
+    while (state.KeepRunning()) {
+        auto matrix = readGrid<int>(text.data(), text.data() + text.size());
+        benchmark::DoNotOptimize(matrix[p00]);
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(readNumbers)->Arg(1000)->Arg(3300);
+
+void loadCharacters(benchmark::State& state) {
+    const std::string text = createCharacterGrid(state.range(0));
+    while (state.KeepRunning()) {
+        std::istringstream ss{text};
+        auto matrix = loadMatrix<char>(ss, '#', 0, 0, true);
+        benchmark::DoNotOptimize(matrix[p00]);
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(loadCharacters)->Arg(1000)->Arg(3300);
+
+void readCharacters(benchmark::State& state) {
+    const std::string text = createCharacterGrid(state.range(0));
+    GridOptions options;
+    options.flip = true;
+    while (state.KeepRunning()) {
+        auto matrix = readGrid<char>(text.data(), text.data() + text.size(),
+                '#', options);
+        benchmark::DoNotOptimize(matrix[p00]);
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(readCharacters)->Arg(1000)->Arg(3300);
+
+} // unnamed namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,94 @@
+#include <Matrix.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+// How Point and Matrix were hashed before.
+std::size_t combinedHash(Point p) {
+    std::size_t seed = 0;
+    hash_combine(seed, p.x);
+    hash_combine(seed, p.y);
+    return seed;
+}
+
+struct CombinedPointHash {
+    std::size_t operator()(Point p) const { return combinedHash(p); }
+};
+
+std::size_t combinedHash(const Matrix<int>& matrix) {
+    std::size_t seed = 0;
+    for (std::size_t i = 0; i < matrix.size(); ++i) {
+        hash_combine(seed, matrix[i]);
+    }
+    return seed;
+}
+
+Matrix<int> createMatrix(std::size_t size) {
+    Matrix<int> result{size, size};
+    int i = 0;
+    for (int& value : result) {
+        value = i++ % 5;
+    }
+    return result;
+}
+
+std::vector<Point> createPoints(int size) {
+    std::vector<Point> result;
+    for (Point p : PointRange{p00, Point(size, size)}) {
+        result.push_back(p);
+    }
+    return result;
+}
+
+void matrixHashCombined(benchmark::State& state) {
+    const auto matrix = createMatrix(state.range(0));
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(combinedHash(matrix));
+    }
+    state.SetBytesProcessed(state.iterations() * matrix.size() * sizeof(int));
+}
+BENCHMARK(matrixHashCombined)->Arg(100)->Arg(3300);
+
+void matrixHashBytes(benchmark::State& state) {
+    const auto matrix = createMatrix(state.range(0));
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(std::hash<Matrix<int>>{}(matrix));
+    }
+    state.SetBytesProcessed(state.iterations() * matrix.size() * sizeof(int));
+}
+BENCHMARK(matrixHashBytes)->Arg(100)->Arg(3300);
+
+// Fills a hash set with the points of a square. Reports how many points share
+// the low 16 bits of their hash with an earlier point, which is what a table
+// with a power of two number of buckets looks at.
+template<typename Hash>
+void pointSet(benchmark::State& state) {
+    const auto points = createPoints(state.range(0));
+    while (state.KeepRunning()) {
+        std::unordered_set<Point, Hash> set;
+        set.reserve(points.size());
+        for (Point p : points) {
+            set.insert(p);
+        }
+        benchmark::DoNotOptimize(set.size());
+    }
+    std::vector<bool> used(1 << 16);
+    std::size_t collisions = 0;
+    for (Point p : points) {
+        auto bucket = Hash{}(p) & 0xffff;
+        collisions += used[bucket];
+        used[bucket] = true;
+    }
+    state.SetItemsProcessed(state.iterations() * points.size());
+    state.counters["low16collisions"] = collisions;
+}
+BENCHMARK_TEMPLATE(pointSet, CombinedPointHash)->Arg(64)->Arg(256);
+BENCHMARK_TEMPLATE(pointSet, std::hash<Point>)->Arg(64)->Arg(256);
+
+} // unnamed namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,72 @@
+#include <all.cpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// The solver backtracks on big random boards and does not finish them yet, so
+// every solve gets the same budget as lakotelep_stress. The solved and
+// timed_out counters tell how many of the solves finished.
+const auto budget = std::chrono::seconds(1);
+
+// Same boards as pair::generate(), but with a fixed seed so that every run
+// solves the same problem.
+Matrix<int> createBoard(int size) {
+    std::vector<Point> ps;
+    for (Point p : PointRange{p00, Point(size, size)}) {
+        ps.push_back(p);
+    }
+    std::mt19937 generator{42};
+    std::shuffle(ps.begin(), ps.end(), generator);
+    auto board = pair::build(size, size, ps);
+    for (int& value : board) {
+        if (value > 4) {
+            value = 1;
+        }
+    }
+    return board;
+}
+
+void solveBoard(benchmark::State& state) {
+    const auto board = createBoard(state.range(0));
+    SolveStats stats;
+    int counts[3] = {0, 0, 0};
+    while (state.KeepRunning()) {
+        auto result = solve(board, deadlineAfter(budget));
+        benchmark::DoNotOptimize(result.path.data());
+        state.PauseTiming();
+        if (result.status == SolveStatus::solved &&
+                !check(result.path, board)) {
+            throw std::logic_error{"Wrong solution"};
+        }
+        ++counts[static_cast<int>(result.status)];
+        stats = result.stats;
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * board.size());
+    double iterations = state.iterations();
+    state.counters["solved"] =
+            counts[static_cast<int>(SolveStatus::solved)] / iterations;
+    state.counters["timed_out"] =
+            counts[static_cast<int>(SolveStatus::timedOut)] / iterations;
+    state.counters["false_paths"] = stats.falsePaths;
+    state.counters["flood_errors"] = stats.floodErrors;
+    state.counters["decided_cells"] = stats.decidedCells;
+}
+
+void sizes(benchmark::internal::Benchmark* benchmark) {
+    for (int size : {10, 20, 40, 100, 330, 1000, 3300}) {
+        benchmark->Arg(size);
+    }
+}
+BENCHMARK(solveBoard)->Apply(sizes)->Unit(benchmark::kMillisecond);
+
+} // unnamed namespace
+
+BENCHMARK_MAIN();
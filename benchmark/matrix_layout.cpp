@@ -0,0 +1,110 @@
+#include <Matrix.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+namespace {
+
+template<typename Layout>
+Matrix<int, Layout> createMatrix(std::size_t size) {
+    Matrix<int, Layout> result{size, size};
+    std::mt19937 generator{42};
+    std::uniform_int_distribution<int> distribution{0, 5};
+    for (Point p : matrixRange(result)) {
+        result[p] = distribution(generator);
+    }
+    return result;
+}
+
+std::vector<Point> createCenters(std::size_t size, int margin,
+        std::size_t count) {
+    std::mt19937 generator{42};
+    std::uniform_int_distribution<int> distribution{margin,
+            static_cast<int>(size) - margin - 1};
+    std::vector<Point> result;
+    for (std::size_t i = 0; i < count; ++i) {
+        result.emplace_back(distribution(generator), distribution(generator));
+    }
+    return result;
+}
+
+// 4-neighbor stencil over the whole matrix in row order, like the flood in
+// lakotelep.
+template<typename Layout>
+void stencil(benchmark::State& state) {
+    const auto matrix = createMatrix<Layout>(state.range(0));
+    PointRange range{p11, Point(matrix.width() - 1, matrix.height() - 1)};
+    while (state.KeepRunning()) {
+        int sum = 0;
+        for (Point p : range) {
+            sum += matrix[p + p10] + matrix[p - p10] + matrix[p + p01] +
+                    matrix[p - p01];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() *
+            (matrix.width() - 2) * (matrix.height() - 2));
+}
+BENCHMARK_TEMPLATE(stencil, RowMajorLayout)->Arg(1000)->Arg(3300);
+BENCHMARK_TEMPLATE(stencil, TiledLayout<8>)->Arg(1000)->Arg(3300);
+BENCHMARK_TEMPLATE(stencil, TiledLayout<32>)->Arg(1000)->Arg(3300);
+
+// Square neighborhood around random centers, like the spread area scans in
+// creep.
+template<typename Layout>
+void squareScan(benchmark::State& state) {
+    constexpr int radius = 10;
+    const auto matrix = createMatrix<Layout>(state.range(0));
+    const auto centers = createCenters(matrix.width(), radius, 1024);
+    while (state.KeepRunning()) {
+        int sum = 0;
+        for (Point center : centers) {
+            for (Point p : PointRange{center - p11 * radius,
+                    center + p11 * (radius + 1)}) {
+                sum += matrix[p];
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * 1024 *
+            (2 * radius + 1) * (2 * radius + 1));
+}
+BENCHMARK_TEMPLATE(squareScan, RowMajorLayout)->Arg(1000)->Arg(3300);
+BENCHMARK_TEMPLATE(squareScan, TiledLayout<8>)->Arg(1000)->Arg(3300);
+BENCHMARK_TEMPLATE(squareScan, TiledLayout<32>)->Arg(1000)->Arg(3300);
+
+// Random walk to neighboring cells, like a depth first search over a group.
+template<typename Layout>
+void neighborWalk(benchmark::State& state) {
+    constexpr std::size_t steps = 1 << 20;
+    const auto matrix = createMatrix<Layout>(state.range(0));
+    std::mt19937 generator{42};
+    std::vector<Point> directions;
+    for (std::size_t i = 0; i < steps; ++i) {
+        Point directionsToChoose[] = {p10, -p10, p01, -p01};
+        directions.push_back(directionsToChoose[generator() % 4]);
+    }
+    while (state.KeepRunning()) {
+        int sum = 0;
+        Point p{static_cast<int>(matrix.width() / 2),
+                static_cast<int>(matrix.height() / 2)};
+        for (Point direction : directions) {
+            Point next = p + direction;
+            if (isInsideMatrix(matrix, next)) {
+                p = next;
+            }
+            sum += matrix[p];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * steps);
+}
+BENCHMARK_TEMPLATE(neighborWalk, RowMajorLayout)->Arg(1000)->Arg(3300);
+BENCHMARK_TEMPLATE(neighborWalk, TiledLayout<8>)->Arg(1000)->Arg(3300);
+BENCHMARK_TEMPLATE(neighborWalk, TiledLayout<32>)->Arg(1000)->Arg(3300);
+
+} // unnamed namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,80 @@
+#include "AllocationCounter.hpp"
+
+#include <Neighbors.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+
+// How getNeigbors() looked before.
+template <typename T, typename Layout>
+std::vector<Point> getNeigborsVector(const Matrix<T, Layout>& m, Point p) {
+    std::vector<Point> result = {p + p01, p - p01, p + p10, p - p10};
+    result.erase(std::remove_if(result.begin(), result.end(), [&m](auto& p) {
+                     return !isInsideMatrix(m, p);
+                 }), result.end());
+    return result;
+}
+
+Matrix<int> createMatrix(std::size_t size) {
+    Matrix<int> result{size, size};
+    std::mt19937 generator{42};
+    std::uniform_int_distribution<int> distribution{0, 4};
+    for (Point p : matrixRange(result)) {
+        result[p] = distribution(generator);
+    }
+    return result;
+}
+
+// Counts the non-zero neighbors of the neighbors of every cell, like
+// hasNeighbourPlacedBefore() in lakotelep.
+template<typename GetNeighbors>
+void neighborsOfNeighbors(benchmark::State& state,
+        GetNeighbors getNeighbors) {
+    const auto matrix = createMatrix(state.range(0));
+    std::size_t allocations = allocationCount();
+    while (state.KeepRunning()) {
+        int sum = 0;
+        for (Point p : matrixRange(matrix)) {
+            for (Point n : getNeighbors(matrix, p)) {
+                for (Point nn : getNeighbors(matrix, n)) {
+                    sum += matrix[nn] != 0;
+                }
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * matrix.size());
+    state.counters["allocs/cell"] = static_cast<double>(
+            allocationCount() - allocations) /
+            (state.iterations() * matrix.size());
+}
+
+void neighborsVector(benchmark::State& state) {
+    neighborsOfNeighbors(state, [](const Matrix<int>& m, Point p) {
+                return getNeigborsVector(m, p);
+            });
+}
+BENCHMARK(neighborsVector)->Arg(100)->Arg(1000);
+
+void neighborsStatic(benchmark::State& state) {
+    neighborsOfNeighbors(state, [](const Matrix<int>& m, Point p) {
+                return getNeigbors(m, p);
+            });
+}
+BENCHMARK(neighborsStatic)->Arg(100)->Arg(1000);
+
+void surroundingNeighbors(benchmark::State& state) {
+    neighborsOfNeighbors(state, [](const Matrix<int>& m, Point p) {
+                return getSurroundingNeigbors(m, p);
+            });
+}
+BENCHMARK(surroundingNeighbors)->Arg(100)->Arg(1000);
+
+} // unnamed namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,59 @@
+#include <Matrix.hpp>
+#include <ParallelForEach.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+
+namespace {
+
+Matrix<int> createMatrix(std::size_t size) {
+    Matrix<int> result{size, size};
+    int i = 0;
+    for (int& value : result) {
+        value = i++ % 7;
+    }
+    return result;
+}
+
+void iterateRange(benchmark::State& state) {
+    const auto matrix = createMatrix(state.range(0));
+    while (state.KeepRunning()) {
+        int sum = 0;
+        for (Point p : matrixRange(matrix)) {
+            sum += matrix[p];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * matrix.size());
+}
+BENCHMARK(iterateRange)->Arg(1000)->Arg(3300);
+
+void iterateForEachPoint(benchmark::State& state) {
+    const auto matrix = createMatrix(state.range(0));
+    while (state.KeepRunning()) {
+        int sum = 0;
+        forEachPoint(matrixRange(matrix), [&](Point p) { sum += matrix[p]; });
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * matrix.size());
+}
+BENCHMARK(iterateForEachPoint)->Arg(1000)->Arg(3300);
+
+void iterateParallel(benchmark::State& state) {
+    const auto matrix = createMatrix(state.range(0));
+    Matrix<int> result{matrix.width(), matrix.height()};
+    while (state.KeepRunning()) {
+        parallelForEach(matrixRange(matrix), [&](Point p) {
+                    result[p] = matrix[p] * 2 + 1;
+                }, state.range(1));
+        benchmark::DoNotOptimize(result[p00]);
+    }
+    state.SetItemsProcessed(state.iterations() * matrix.size());
+}
+BENCHMARK(iterateParallel)->Args({3300, 1})->Args({3300, 2})->Args({3300, 4})
+        ->UseRealTime();
+
+} // unnamed namespace
+
+BENCHMARK_MAIN();
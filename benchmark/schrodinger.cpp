@@ -0,0 +1,52 @@
+#include <solution.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+
+// FindRadioactiveBalls() takes a plain function pointer, so the test
+// function reads its state from here.
+std::vector<bool> radioactive;
+std::size_t testCount = 0;
+
+bool testBalls(const std::vector<std::size_t>& balls) {
+    ++testCount;
+    return std::any_of(balls.begin(), balls.end(),
+            [](std::size_t ball) { return radioactive[ball]; });
+}
+
+void findRadioactiveBalls(benchmark::State& state) {
+    std::size_t numBalls = state.range(0);
+    std::size_t numRadioactive = state.range(1);
+    std::mt19937 generator{42};
+    std::vector<std::size_t> balls(numBalls);
+    std::iota(balls.begin(), balls.end(), 0);
+    std::size_t tests = 0;
+    std::size_t runs = 0;
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        std::shuffle(balls.begin(), balls.end(), generator);
+        radioactive.assign(numBalls, false);
+        for (std::size_t i = 0; i < numRadioactive; ++i) {
+            radioactive[balls[i]] = true;
+        }
+        testCount = 0;
+        state.ResumeTiming();
+        auto result = FindRadioactiveBalls(numBalls, numRadioactive,
+                testBalls);
+        benchmark::DoNotOptimize(result.data());
+        tests += testCount;
+        ++runs;
+    }
+    state.counters["tests"] = static_cast<double>(tests) / runs;
+}
+BENCHMARK(findRadioactiveBalls)->ArgsProduct({{8, 16, 32, 64}, {1, 3, 7}});
+
+} // unnamed namespace
+
+BENCHMARK_MAIN();
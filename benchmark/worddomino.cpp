@@ -0,0 +1,55 @@
+#include <WordChain.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+// Random words over a small alphabet, so that many of them overlap. The
+// result is sorted like readWords() returns it.
+std::vector<std::string> createWords(std::size_t count) {
+    std::mt19937 generator{42};
+    std::uniform_int_distribution<std::size_t> lengthDistribution{3, 10};
+    std::uniform_int_distribution<int> letterDistribution{'a', 'f'};
+    std::unordered_set<std::string> words;
+    while (words.size() < count) {
+        std::string word(lengthDistribution(generator), ' ');
+        for (char& c : word) {
+            c = static_cast<char>(letterDistribution(generator));
+        }
+        words.insert(word);
+    }
+    std::vector<std::string> result{words.begin(), words.end()};
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+void findMatches(benchmark::State& state) {
+    const auto words = createWords(state.range(0));
+    while (state.KeepRunning()) {
+        auto matches = matchWords(words, false);
+        benchmark::DoNotOptimize(matches.data());
+    }
+    state.SetItemsProcessed(state.iterations() * words.size());
+}
+BENCHMARK(findMatches)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+void buildChain(benchmark::State& state) {
+    const auto words = createWords(state.range(0));
+    const auto matches = matchWords(words, false);
+    while (state.KeepRunning()) {
+        auto wordChain = generateWordChain(matches, words.size());
+        benchmark::DoNotOptimize(wordChain.data());
+    }
+    state.SetItemsProcessed(state.iterations() * matches.size());
+}
+BENCHMARK(buildChain)->Arg(1000)->Arg(10000);
+
+} // unnamed namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,160 @@
+#include "LowerBound.hpp"
+
+#include "Constants.hpp"
+#include "Spread.hpp"
+
+#include <algorithm>
+#include <deque>
+
+namespace {
+
+constexpr int unreachable = std::numeric_limits<int>::max();
+
+// Distance of each floor from the nearest creep, walking on floors only. The
+// creep can only grow to neighboring floors, so a floor cannot get creep
+// sooner than this many spreads.
+Matrix<int> calculateCreepDistances(const Status& status) {
+    Matrix<int> result{status.width(), status.height(), unreachable};
+    std::deque<Point> queue;
+    for (Point p : matrixRange(result)) {
+        if (!status.isFloor(p) && !status.isWall(p)) {
+            result[p] = 0;
+            queue.push_back(p);
+        }
+    }
+    while (!queue.empty()) {
+        Point p = queue.front();
+        queue.pop_front();
+        for (Point direction : {p10, -p10, p01, -p01}) {
+            Point neighbor = p + direction;
+            if (isInsideMatrix(result, neighbor) && status.isFloor(neighbor) &&
+                    result[neighbor] == unreachable) {
+                result[neighbor] = result[p] + 1;
+                queue.push_back(neighbor);
+            }
+        }
+    }
+    return result;
+}
+
+// The maximum number of tumors at each tick until the time limit.
+std::vector<std::size_t> calculateMaximumTumors(const Status& status,
+        int timeLimit) {
+    std::vector<std::size_t> result;
+    std::size_t tumors = status.getTumors().size();
+    // the next time each tumor that is not inactive, or its descendant, can
+    // place a new tumor
+    std::vector<int> placeTimes;
+    for (const Tumor& tumor : status.getTumors()) {
+        if (tumor.cooldown >= 0) {
+            placeTimes.push_back(status.getTime() + tumor.cooldown);
+        }
+    }
+    std::vector<int> energies;
+    for (const Queen& queen : status.getQueens()) {
+        energies.push_back(queen.energy);
+    }
+    for (int time = status.getTime(); time < timeLimit; ++time) {
+        for (int& placeTime : placeTimes) {
+            if (placeTime == time) {
+                ++tumors;
+                placeTime += rules::tumorCooldownTime;
+            }
+        }
+        for (int& energy : energies) {
+            while (energy >= rules::queenEnertyRequirement) {
+                energy -= rules::queenEnertyRequirement;
+                ++tumors;
+                placeTimes.push_back(time + rules::tumorCooldownTime);
+            }
+        }
+        result.push_back(tumors);
+
+        for (int& energy : energies) {
+            if (energy < rules::queenMaximumEnergy) {
+                ++energy;
+            }
+        }
+        if ((time + 1) % rules::queenSpawnTime == 0) {
+            energies.push_back(rules::queenStartingEnergy);
+        }
+    }
+    return result;
+}
+
+} // unnamed namespace
+
+SolutionBound calculateLowerBound(const Status& status, int timeLimit) {
+    std::size_t floorsRemaining = status.getFloorsRemaining();
+    if (floorsRemaining == 0) {
+        return {0, status.getTime()};
+    }
+
+    Matrix<int> distances = calculateCreepDistances(status);
+    // floors out of the spread area of every existing tumor need a new tumor
+    Matrix<bool> covered{status.width(), status.height(), false};
+    for (const Tumor& tumor : status.getTumors()) {
+        iterateSpreadArea(getMax(status), tumor.position,
+                rules::creepSpreadRadius,
+                [&covered](Point p) { covered[p] = true; });
+    }
+    std::vector<int> floorDistances;
+    std::vector<int> uncoveredDistances;
+    for (Point p : matrixRange(distances)) {
+        if (status.isFloor(p)) {
+            floorDistances.push_back(distances[p]);
+            if (!covered[p]) {
+                uncoveredDistances.push_back(distances[p]);
+            }
+        }
+    }
+    std::sort(floorDistances.begin(), floorDistances.end());
+
+    std::vector<std::size_t> tumors = calculateMaximumTumors(status, timeLimit);
+    std::size_t initialTumors = status.getTumors().size();
+    auto newTumor = std::find_if(tumors.begin(), tumors.end(),
+            [initialTumors](std::size_t value) {
+                return value > initialTumors;
+            });
+    // ticks before the first new tumor can spread creep
+    std::size_t ticksWithoutNewTumor = newTumor - tumors.begin();
+
+    std::size_t spreads = 0;
+    for (std::size_t tick = 0; tick < tumors.size(); ++tick) {
+        spreads += tumors[tick];
+        bool allCovered = uncoveredDistances.empty() ||
+                tick >= ticksWithoutNewTumor;
+        if (spreads >= floorsRemaining &&
+                static_cast<std::size_t>(floorDistances.back()) <= spreads &&
+                allCovered) {
+            return {0, status.getTime() + static_cast<int>(tick) + 1};
+        }
+    }
+
+    // The floors farther than the number of possible spreads cannot be
+    // reached, neither the uncovered floors if there is no new tumor.
+    std::size_t farFloors = floorDistances.end() - std::upper_bound(
+            floorDistances.begin(), floorDistances.end(),
+            static_cast<int>(std::min<std::size_t>(spreads, unreachable - 1)));
+    std::size_t uncoveredFloors = newTumor == tumors.end() ?
+            uncoveredDistances.size() : 0;
+    std::size_t minimumFloors = floorsRemaining > spreads ?
+            floorsRemaining - spreads : 0;
+    return {std::max({minimumFloors, farFloors, uncoveredFloors,
+            std::size_t{1}}), status.getTime()};
+}
+
+void Incumbent::update(std::size_t floorsRemaining, int time) {
+    std::unique_lock<std::mutex> lock{mutex};
+    if (floorsRemaining < this->floorsRemaining || (
+            floorsRemaining == this->floorsRemaining && time < this->time)) {
+        this->floorsRemaining = floorsRemaining;
+        this->time = time;
+    }
+}
+
+bool Incumbent::isBetterThan(const SolutionBound& bound) const {
+    std::unique_lock<std::mutex> lock{mutex};
+    return floorsRemaining < bound.floorsRemaining || (
+            floorsRemaining == bound.floorsRemaining && time < bound.time);
+}
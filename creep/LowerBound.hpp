@@ -0,0 +1,36 @@
+#ifndef CREEP_LOWERBOUND_HPP
+#define CREEP_LOWERBOUND_HPP
+
+#include "Status.hpp"
+
+#include <limits>
+#include <mutex>
+
+struct SolutionBound {
+    std::size_t floorsRemaining;
+    int time;
+};
+
+// Optimistic estimate of the result reachable from the status: no
+// continuation of the game ends with fewer floors remaining, or with the same
+// floors remaining at an earlier time. It assumes that every tumor places a
+// new one as soon as its cooldown is over and the queens place tumors as soon
+// as they have the energy, and each tumor spreads creep to one floor per tick.
+SolutionBound calculateLowerBound(const Status& status, int timeLimit);
+
+// The best (floors remaining, time) found so far. It can be shared between
+// solver runs in different threads.
+class Incumbent {
+public:
+    void update(std::size_t floorsRemaining, int time);
+
+    // True if no solution with this bound can beat the incumbent.
+    bool isBetterThan(const SolutionBound& bound) const;
+
+private:
+    mutable std::mutex mutex;
+    std::size_t floorsRemaining = std::numeric_limits<std::size_t>::max();
+    int time = std::numeric_limits<int>::max();
+};
+
+#endif // CREEP_LOWERBOUND_HPP
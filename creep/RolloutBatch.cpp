@@ -0,0 +1,49 @@
+#include "RolloutBatch.hpp"
+
+#include <util/ThreadPool.hpp>
+
+#include <exception>
+
+std::vector<RolloutResult> RolloutBatch::run(std::size_t numThreads) const {
+    std::vector<RolloutResult> results(candidates.size());
+    if (numThreads <= 1) {
+        for (std::size_t i = 0; i < candidates.size(); ++i) {
+            results[i] = rollout(candidates[i]);
+        }
+        return results;
+    }
+
+    // An exception must not leave a job, it would end the worker thread and
+    // the whole program with it.
+    std::vector<std::exception_ptr> errors(candidates.size());
+    util::ThreadPool threadPool{numThreads};
+    boost::asio::io_service& ioService = threadPool.getIoService();
+    threadPool.start();
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        // every job writes only its own slot
+        ioService.post([this, i, &results, &errors]() {
+                    try {
+                        results[i] = rollout(candidates[i]);
+                    } catch (...) {
+                        errors[i] = std::current_exception();
+                    }
+                });
+    }
+    threadPool.wait();
+    for (const std::exception_ptr& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    return results;
+}
+
+RolloutResult RolloutBatch::rollout(const Command& candidate) const {
+    Game game = baseGame;
+    game.addCommand(candidate);
+    while (game.canContinue()) {
+        game.tick();
+    }
+    const Status& status = game.getStatus();
+    return {status.getFloorsRemaining(), status.getTime(), status.getTable()};
+}
@@ -0,0 +1,39 @@
+#ifndef CREEP_ROLLOUTBATCH_HPP
+#define CREEP_ROLLOUTBATCH_HPP
+
+#include "Command.hpp"
+#include "Game.hpp"
+#include "Table.hpp"
+
+#include <vector>
+
+struct RolloutResult {
+    std::size_t floorsRemaining;
+    int time;
+    Table creepTimes; // same encoding as Status::creepTime()
+};
+
+// Simulates the base game with each candidate command added to it until
+// canContinue() is false. The batch keeps its own copy of the base game,
+// which the rollouts share and only read. The results are in the order of
+// the candidates and do not depend on the number of threads.
+class RolloutBatch {
+public:
+    RolloutBatch(Game baseGame, std::vector<Command> candidates) :
+            baseGame(std::move(baseGame)), candidates(std::move(candidates)) {
+    }
+
+    // If a rollout throws, the others still finish, then the exception of
+    // the first such candidate is thrown.
+    std::vector<RolloutResult> run(std::size_t numThreads = 1) const;
+
+    const std::vector<Command>& getCandidates() const { return candidates; }
+
+private:
+    RolloutResult rollout(const Command& candidate) const;
+
+    Game baseGame;
+    std::vector<Command> candidates;
+};
+
+#endif // CREEP_ROLLOUTBATCH_HPP
@@ -5,6 +5,7 @@
 #include "Spread.hpp"
 
 #include <DumperFunctions.hpp>
+#include <ParallelForEach.hpp>
 
 #include <boost/format.hpp>
 #include <boost/container/flat_set.hpp>
@@ -17,18 +18,29 @@ namespace {
 
 struct Finished {};
 
+// The lower bound is a search on the whole map, so it is only calculated
+// again when this many ticks passed since the last time.
+constexpr int boundCheckInterval = 10;
+
 class SolverImpl {
 public:
     SolverImpl(Game& game, const Heuristics& heuristics,
-            std::shared_ptr<Node> startingNode) :
+            std::shared_ptr<Node> startingNode, const Incumbent* incumbent,
+            std::size_t numThreads) :
             game(game), currentNode(std::move(startingNode)),
-            heuristics(heuristics) {
+            heuristics(heuristics), incumbent(incumbent),
+            numThreads(numThreads) {
     }
 
     std::shared_ptr<Node> solve() {
         if (!currentNode) {
             addQueenAction(game.getStatus().getQueens()[0]);
-            tick();
+            try {
+                tick();
+            } catch (Finished&) {
+                // a small map can be covered by the first tick
+                return currentNode;
+            }
         } else {
             for (auto node = currentNode;
                     node && node->command.time == game.getStatus().getTime();
@@ -40,6 +52,8 @@ public:
         return currentNode;
     }
 
+    bool isAborted() const { return aborted; }
+
 private:
     void doSolve() {
         std::size_t iterations = 0;
@@ -50,6 +64,11 @@ private:
                 didSomething = false;
                 LOG << "Iteration: " << iterations << "\n";
                 forwardToNextAvailableTumor();
+                if (cannotBeatIncumbent()) {
+                    LOG << "Cannot beat the incumbent, aborting.\n";
+                    aborted = true;
+                    return;
+                }
                 LOG << "Moved to time: " << game.getStatus().getTime() << "\n";
                 LOG << "Pending actions: ";
                 for (int id : pendingActions) {
@@ -88,6 +107,18 @@ private:
         }
     }
 
+    // The bound only gets worse when the time passes, and the search moves
+    // forward in time, so checking it later only stops the search later.
+    bool cannotBeatIncumbent() {
+        int time = game.getStatus().getTime();
+        if (!incumbent || time < nextBoundCheck) {
+            return false;
+        }
+        nextBoundCheck = time + boundCheckInterval;
+        return incumbent->isBetterThan(calculateLowerBound(
+                game.getStatus(), game.getTimeLimit()));
+    }
+
     void forwardToNextAvailableTumor() {
         while (
                 !std::any_of(game.getStatus().getTumors().begin(),
@@ -145,25 +176,30 @@ private:
                         heuristicsTable[p].time = game.getStatus().getTime();
                     }
                 });
-        auto spreadPoints = findSpreadArea(getMax(game.getStatus()),
+        SpreadArea spreadPoints;
+        findSpreadArea(getMax(game.getStatus()),
                 tumor.position, rules::creepSpreadRadius,
-                notPendingPredicate(game.getStatus(), &Status::isFloor));
+                notPendingPredicate(game.getStatus(), &Status::isFloor),
+                spreadPoints);
         Game gameTmp = game;
         while (gameTmp.canContinue()) {
             gameTmp.tick();
-            std::vector<Point> newSpreadPoints;
+            // filter in place, the points still waiting for creep are kept
+            auto newEnd = spreadPoints.begin();
             for (Point p : spreadPoints) {
                 if (gameTmp.getStatus().isCreep(p)) {
                     heuristicsTable[p].time = gameTmp.getStatus().getTime();
                 } else if (gameTmp.getStatus().isFloor(p)) {
-                    newSpreadPoints.push_back(p);
+                    *newEnd++ = p;
                 }
             }
-            spreadPoints = std::move(newSpreadPoints);
+            spreadPoints.erase(newEnd, spreadPoints.end());
         }
-        auto consideredPoints = findSpreadArea(getMax(game.getStatus()),
+        SpreadArea consideredPoints;
+        findSpreadArea(getMax(game.getStatus()),
                 tumor.position, rules::creepSpreadRadius,
-                getPredicate(gameTmp.getStatus(), &Status::isCreep));
+                getPredicate(gameTmp.getStatus(), &Status::isCreep),
+                consideredPoints);
         if (consideredPoints.empty()) {
             LOG << "Tumor " << tumor.id <<
                     " surrounded, cannot add more tumors.";
@@ -224,17 +260,26 @@ private:
     void addQueenAction(const Queen& queen) {
         const Status& status = game.getStatus();
         Matrix<float> spreadPossibilities{status.width(), status.height(), 0};
+        // Every point is scored independently, so the rows can be scored in
+        // parallel. The candidates are collected afterwards in row order to
+        // keep the choice of the best point deterministic.
+        parallelForEach(matrixRange(spreadPossibilities),
+                [&](Point p) {
+                    if (status.isCreep(p) && isNotPending(p)) {
+                        spreadPossibilities[p] = countSpreadArea(
+                                getMax(status), p, rules::creepSpreadRadius,
+                                getPredicate(status, &Status::isFloor)) *
+                                heuristics.spreadRadiusMultiplier +
+                                calculateDistanceValue(p);
+                    }
+                }, numThreads);
         std::vector<Point> candidates;
-        for (Point p : matrixRange(spreadPossibilities)) {
-            if (status.isCreep(p) && isNotPending(p)) {
-                spreadPossibilities[p] = countSpreadArea(
-                        getMax(game.getStatus()), p, rules::creepSpreadRadius,
-                        getPredicate(status, &Status::isFloor)) *
-                        heuristics.spreadRadiusMultiplier +
-                        calculateDistanceValue(p);
-                candidates.push_back(p);
-            }
-        }
+        forEachPoint(matrixRange(spreadPossibilities),
+                [&](Point p) {
+                    if (status.isCreep(p) && isNotPending(p)) {
+                        candidates.push_back(p);
+                    }
+                });
         Point bestPoint = *std::max_element(
                 candidates.begin(), candidates.end(),
                 [&spreadPossibilities](const Point& lhs, const Point& rhs) {
@@ -280,6 +325,10 @@ private:
     Game& game;
     std::shared_ptr<Node> currentNode;
     const Heuristics heuristics;
+    const Incumbent* incumbent;
+    std::size_t numThreads;
+    bool aborted = false;
+    int nextBoundCheck = 0;
     boost::container::flat_set<int> pendingActions;
     boost::container::flat_set<Point> pendingPositions;
 };
@@ -287,13 +336,16 @@ private:
 } // unnamed namespace
 
 Solution findSolution(Game game, const Heuristics& heuristics,
-        std::shared_ptr<Node> startingNode) {
+        std::shared_ptr<Node> startingNode, const Incumbent* incumbent,
+        std::size_t numThreads) {
     LOG << "Solve: tm=" << heuristics.timeMultiplier <<
             " dsm=" << heuristics.distanceSquareMultiplier <<
             " srm=" << heuristics.spreadRadiusMultiplier << "\n";
     Solution result;
-    SolverImpl impl{game, heuristics, std::move(startingNode)};
+    SolverImpl impl{game, heuristics, std::move(startingNode), incumbent,
+            numThreads};
     result.node = impl.solve();
+    result.aborted = impl.isAborted();
     result.time = game.getStatus().getTime();
     result.floorsRemaining = game.getStatus().getFloorsRemaining();
     result.heuristics = heuristics;
@@ -301,6 +353,7 @@ Solution findSolution(Game game, const Heuristics& heuristics,
             " dsm=" << heuristics.distanceSquareMultiplier <<
             " srm=" << heuristics.spreadRadiusMultiplier <<
             " floors=" << result.floorsRemaining <<
-            " time=" << result.time << "\n";
+            " time=" << result.time <<
+            (result.aborted ? " aborted" : "") << "\n";
     return result;
 }
@@ -3,6 +3,7 @@
 
 #include "Command.hpp"
 #include "Game.hpp"
+#include "LowerBound.hpp"
 #include "Node.hpp"
 
 struct Heuristics {
@@ -16,9 +17,15 @@ struct Solution {
     Heuristics heuristics;
     int floorsRemaining;
     int time;
+    // The run was stopped because it could not beat the incumbent. The
+    // floors remaining and the time are not final then.
+    bool aborted = false;
 };
 
+// numThreads is the number of threads used to score the positions of the
+// tumors placed by queens.
 Solution findSolution(Game game, const Heuristics& heuristics,
-        std::shared_ptr<Node> startingNode = nullptr);
+        std::shared_ptr<Node> startingNode = nullptr,
+        const Incumbent* incumbent = nullptr, std::size_t numThreads = 1);
 
 #endif // CREEP_SOLVER_HPP
@@ -2,17 +2,21 @@
 #define CREEP_SPREAD_HPP
 
 #include "CircleCache.hpp"
+#include "Constants.hpp"
 
 #include <Point.hpp>
 
 #include <boost/container/flat_map.hpp>
+#include <boost/container/static_vector.hpp>
 
 #include <vector>
 
 template<typename Function>
 void iterateSpreadArea(Point bound, Point center, int radius,
         const Function& function) {
-    static CircleCache circleCache;
+    // one cache per thread, so that parallel simulations do not contend for
+    // the lock of the cache
+    static thread_local CircleCache circleCache;
     for (Point p : circleCache.get(radius)) {
         Point pp = p + center;
         if (pp.x >= 0 && pp.x < bound.x && pp.y >= 0 && pp.y < bound.y) {
@@ -34,16 +38,36 @@ std::size_t countSpreadArea(Point max, Point center, int radius,
     return result;
 }
 
-template<typename Predicate>
-std::vector<Point> findSpreadArea(Point max, Point center, int radius,
-        const Predicate& predicate) {
-    std::vector<Point> result;
+// Upper bound of the number of points in a circle of the given radius.
+constexpr std::size_t maxSpreadAreaSize(int radius) {
+    return 4 * radius * radius;
+}
+
+// Fixed capacity buffer that can hold the spread area of one tumor without
+// heap allocation.
+using SpreadArea = boost::container::static_vector<Point,
+        maxSpreadAreaSize(rules::creepSpreadRadius)>;
+
+// Stores the result into a caller provided container, so that it can be
+// reused between calls. The order of the points is the same as in
+// iterateSpreadArea().
+template<typename Predicate, typename Container>
+void findSpreadArea(Point max, Point center, int radius,
+        const Predicate& predicate, Container& result) {
+    result.clear();
     iterateSpreadArea(max, center, radius,
             [&result, &predicate](Point p) {
                 if (predicate(p)) {
                     result.push_back(p);
                 }
             });
+}
+
+template<typename Predicate>
+std::vector<Point> findSpreadArea(Point max, Point center, int radius,
+        const Predicate& predicate) {
+    std::vector<Point> result;
+    findSpreadArea(max, center, radius, predicate, result);
     return result;
 }
 
@@ -97,9 +97,9 @@ void Status::spreadCreep() {
 }
 
 bool Status::spreadCreepFrom(Point p, std::size_t hash) {
-    std::vector<Point> candidates = findSpreadArea(getMax(*this), p,
-            rules::creepSpreadRadius,
-            getPredicate(*this, &Status::isCreepCandidate));
+    SpreadArea candidates;
+    findSpreadArea(getMax(*this), p, rules::creepSpreadRadius,
+            getPredicate(*this, &Status::isCreepCandidate), candidates);
     if (!candidates.empty()) {
         table[candidates[hash % candidates.size()]] = time;
         --floorsRemaining;
@@ -40,7 +40,7 @@ public:
     const Tumor& addTumorFromTumor(int id, Point position);
 
     std::size_t width() const { return table.width(); }
-    std::size_t height() const { return table.width(); }
+    std::size_t height() const { return table.height(); }
     int creepTime(Point p) const { return table[p]; }
     bool isFloor(Point p) const {
         return table[p] == MapElement::Floor || table[p] > time;
@@ -57,6 +57,7 @@ public:
                hasCreep(table[p - p01]) || hasCreep(table[p + p01]));
     }
 
+    const Table& getTable() const { return table; }
     const std::vector<Tumor>& getTumors() const { return tumors; }
     const std::vector<Queen>& getQueens() const { return queens; }
     int getTime() const { return time; }
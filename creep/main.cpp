@@ -26,11 +26,19 @@ void simulate(Game& game, const Options&) {
 
 template<typename OnFinished>
 void doSolve(const Game& game, const Heuristics& heuristics,
-        const OnFinished& onFinished) {
+        Incumbent& incumbent, const OnFinished& onFinished) {
     std::cerr << "Solving: tm=" << heuristics.timeMultiplier <<
             " dsm=" << heuristics.distanceSquareMultiplier <<
             " srm=" << heuristics.spreadRadiusMultiplier << "\n";
-    auto solution = findSolution(game, heuristics);
+    auto solution = findSolution(game, heuristics, nullptr, &incumbent);
+    if (solution.aborted) {
+        std::cerr << "Aborted: tm=" << solution.heuristics.timeMultiplier <<
+                " dsm=" << solution.heuristics.distanceSquareMultiplier <<
+                " srm=" << solution.heuristics.spreadRadiusMultiplier <<
+                " time=" << solution.time << "\n";
+        return;
+    }
+    incumbent.update(solution.floorsRemaining, solution.time);
     std::cerr << "Solved: tm=" << solution.heuristics.timeMultiplier <<
             " dsm=" << solution.heuristics.distanceSquareMultiplier <<
             " srm=" << solution.heuristics.spreadRadiusMultiplier <<
@@ -41,9 +49,10 @@ void doSolve(const Game& game, const Heuristics& heuristics,
 
 void solve(Game& game, const Options& options) {
     std::vector<Solution> solutions;
+    Incumbent incumbent;
     util::ThreadPool threadPool{options.numThreads};
     boost::asio::io_service& ioService = threadPool.getIoService();
-    boost::asio::strand strand{ioService};
+    boost::asio::io_service::strand strand{ioService};
     auto onFinished =
             [&solutions, &ioService, &strand](const Solution& solution) {
                 ioService.post(strand.wrap(
@@ -59,12 +68,13 @@ void solve(Game& game, const Options& options) {
                             iterateFinder(options.spreadRadiusMultiplierFinder,
                                     [&](float spreadRadiusMultiplier) {
                                         ioService.post(
-                                                [=, &game, &onFinished]() {
+                                                [=, &game, &incumbent,
+                                                        &onFinished]() {
                                                     doSolve(game, {
                                                     timeMultiplier,
                                                     distanceSquareMultiplier,
                                                     spreadRadiusMultiplier},
-                                                    onFinished);
+                                                    incumbent, onFinished);
                                                 });
                                     });
                         });
@@ -0,0 +1,104 @@
+#include "Game.hpp"
+#include "GameInfo.hpp"
+#include "LowerBound.hpp"
+#include "RolloutBatch.hpp"
+#include "Solver.hpp"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+// A size x size room with walls around it and a wall in the middle, which
+// the creep has to go around.
+GameInfo smallMap(std::size_t size, int timeLimit) {
+    GameInfo gameInfo;
+    gameInfo.table = Table{size, size, MapElement::Floor};
+    for (Point p : matrixRange(gameInfo.table)) {
+        if (p.x == 0 || p.y == 0 || p.x == static_cast<int>(size) - 1 ||
+                p.y == static_cast<int>(size) - 1 ||
+                (p.x == static_cast<int>(size) / 2 &&
+                 p.y < static_cast<int>(size) - 3)) {
+            gameInfo.table[p] = MapElement::Wall;
+        }
+    }
+    gameInfo.hatcheryPosition = Point(2, 2);
+    gameInfo.timeLimit = timeLimit;
+    return gameInfo;
+}
+
+// A tumor from the first queen on every cell with creep at the start.
+std::vector<Command> queenCandidates(const Game& game) {
+    const Status& status = game.getStatus();
+    std::vector<Command> result;
+    for (Point p : matrixRange(status.getTable())) {
+        if (status.isCreep(p)) {
+            result.push_back(Command{0, CommandType::PlaceTumorFromQueen,
+                    status.getQueens()[0].id, p});
+        }
+    }
+    return result;
+}
+
+// Plays the game to the end and checks that the lower bound of every status
+// on the way is not better than the result.
+void checkLowerBounds(Game game) {
+    std::vector<SolutionBound> bounds;
+    while (true) {
+        bounds.push_back(calculateLowerBound(game.getStatus(),
+                game.getTimeLimit()));
+        if (!game.canContinue()) {
+            break;
+        }
+        game.tick();
+    }
+    Incumbent result;
+    result.update(game.getStatus().getFloorsRemaining(),
+            game.getStatus().getTime());
+    for (const SolutionBound& bound : bounds) {
+        EXPECT_FALSE(result.isBetterThan(bound)) <<
+                "bound " << bound.floorsRemaining << " " << bound.time <<
+                ", result " << game.getStatus().getFloorsRemaining() << " " <<
+                game.getStatus().getTime();
+    }
+}
+
+} // unnamed namespace
+
+TEST(LowerBound, admissible) {
+    for (std::size_t size : {8, 12, 16}) {
+        for (int timeLimit : {50, 150, 300}) {
+            const Game baseGame{smallMap(size, timeLimit)};
+            checkLowerBounds(baseGame);
+            for (const Command& command : queenCandidates(baseGame)) {
+                Game game = baseGame;
+                game.addCommand(command);
+                checkLowerBounds(game);
+            }
+            for (Heuristics heuristics : {Heuristics{0.0f, -1.0f, 1.0f},
+                    Heuristics{-1.0f, -1.0f, 1.0f}}) {
+                Solution solution = findSolution(baseGame, heuristics);
+                Game game = baseGame;
+                for (const Command& command : getCommands(solution.node)) {
+                    game.addCommand(command);
+                }
+                checkLowerBounds(game);
+            }
+        }
+    }
+}
+
+TEST(RolloutBatch, threads) {
+    RolloutBatch batch{Game{smallMap(16, 300)},
+            queenCandidates(Game{smallMap(16, 300)})};
+    ASSERT_GT(batch.getCandidates().size(), 1u);
+    auto expected = batch.run(1);
+    for (std::size_t numThreads : {2, 4}) {
+        auto results = batch.run(numThreads);
+        ASSERT_EQ(expected.size(), results.size());
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            EXPECT_EQ(expected[i].floorsRemaining, results[i].floorsRemaining);
+            EXPECT_EQ(expected[i].time, results[i].time);
+            EXPECT_EQ(expected[i].creepTimes, results[i].creepTimes);
+        }
+    }
+}
@@ -1,10 +1,25 @@
+#include <array>
 #include <vector>
 #include <stack>
 #include <iostream>
 #include <algorithm>
 #include <algorithm>
 #include <unordered_map>
+#include <map>
 #include <cassert>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <boost/container/static_vector.hpp>
+#include <boost/optional.hpp>
 
 // Direction.hpp
 #include <iosfwd>
@@ -19,7 +34,10 @@ enum class Direction {
 std::ostream& operator<<(std::ostream& out, const Direction& direction);
 
 // Hash.hpp
+#include <cstdint>
+#include <cstring>
 #include <functional>
+#include <type_traits>
 
 template <class T>
 inline void hash_combine(std::size_t& seed, const T& v)
@@ -28,6 +46,75 @@ inline void hash_combine(std::size_t& seed, const T& v)
     seed ^= hasher(v) + 0x9e3779b9 + (seed<<6) + (seed>>2);
 }
 
+namespace detail {
+
+constexpr std::uint64_t hashPrime0 = 0xa0761d6478bd642full;
+constexpr std::uint64_t hashPrime1 = 0xe7037ed1a0b428dbull;
+constexpr std::uint64_t hashPrime2 = 0x8ebc6af09c88c6e3ull;
+constexpr std::uint64_t hashPrime3 = 0x589965cc75374cc3ull;
+
+// The high and low halves of the 128 bit product folded together.
+inline std::uint64_t hashMix(std::uint64_t a, std::uint64_t b)
+{
+    unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    return static_cast<std::uint64_t>(product) ^
+            static_cast<std::uint64_t>(product >> 64);
+}
+
+inline std::uint64_t hashRead64(const unsigned char* p)
+{
+    std::uint64_t result;
+    std::memcpy(&result, p, sizeof(result));
+    return result;
+}
+
+} // namespace detail
+
+// 64 bit hash of a block of memory in the style of wyhash. The main loop
+// consumes 32 bytes in four independent lanes, so the multiplications of the
+// lanes overlap.
+inline std::uint64_t hashBytes(const void* data, std::size_t size,
+        std::uint64_t seed = 0)
+{
+    using namespace detail;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    std::uint64_t lanes[4] = {seed ^ hashPrime0, seed ^ hashPrime1,
+            seed ^ hashPrime2, seed ^ hashPrime3};
+    std::size_t remaining = size;
+    for (; remaining >= 32; remaining -= 32, p += 32) {
+        for (int i = 0; i < 4; ++i) {
+            lanes[i] = hashMix(hashRead64(p + 8 * i) ^ hashPrime1,
+                    lanes[i] ^ hashPrime0);
+        }
+    }
+    std::uint64_t result = hashMix(lanes[0] ^ lanes[2], lanes[1] ^ lanes[3]) ^
+            hashPrime2;
+    for (; remaining >= 8; remaining -= 8, p += 8) {
+        result = hashMix(hashRead64(p) ^ hashPrime1, result ^ hashPrime0);
+    }
+    if (remaining != 0) {
+        std::uint64_t tail = 0;
+        std::memcpy(&tail, p, remaining);
+        result = hashMix(tail ^ hashPrime1, result ^ hashPrime0);
+    }
+    return hashMix(result ^ size, hashPrime3);
+}
+
+// Types whose equal values have equal bytes, so that arrays of them can be
+// hashed with hashBytes().
+template <typename T>
+struct IsBytewiseHashable: std::integral_constant<bool,
+        (std::is_integral<T>::value && !std::is_same<T, bool>::value) ||
+        std::is_enum<T>::value> {};
+
+// Hash of two 32 bit values with a single multiplication. The high bits of
+// the product depend on all the input bits and are folded into the low ones.
+inline std::uint64_t hashPair(std::uint32_t a, std::uint32_t b)
+{
+    std::uint64_t product = ((static_cast<std::uint64_t>(a) << 32) | b) *
+            0x9e3779b97f4a7c15ull;
+    return product ^ (product >> 32);
+}
 
 // Point.hpp
 #include <ostream>
@@ -142,15 +229,15 @@ template<>
 struct hash<Point> {
     size_t operator()(Point p) const
     {
-        size_t seed = 0;
-        hash_combine(seed, p.x);
-        hash_combine(seed, p.y);
-        return seed;
+        return hashPair(p.x, p.y);
     }
 };
 
 } // namespace std
 
+template<>
+struct IsBytewiseHashable<Point>: std::true_type {};
+
 // PointRange.hpp
 #include <boost/iterator/iterator_facade.hpp>
 #include <boost/exception/all.hpp>
@@ -159,15 +246,17 @@ struct hash<Point> {
 
 class PointRangeIterator;
 
+// The points of a rectangle, row after row. The iterators are random access
+// and a range can be split into blocks of rows to process them in parallel.
 class PointRange {
 public:
     typedef PointRangeIterator iterator;
+    typedef PointRangeIterator const_iterator;
 private:
     Point begin_;
     Point end_;
 public:
     typedef Point value_type;
-    friend class PointRangeIterator;
 
     PointRange(Point  begin, Point  end):
         begin_(begin),
@@ -190,14 +279,54 @@ public:
         }
         return Point(end_.x - 1, end_.y - 1);
     }
+
+    Point topLeft() const { return begin_; }
+    Point bottomRight() const { return end_; }
+    bool empty() const { return begin_.x >= end_.x || begin_.y >= end_.y; }
+    int width() const { return empty() ? 0 : end_.x - begin_.x; }
+    int height() const { return empty() ? 0 : end_.y - begin_.y; }
+    std::size_t size() const
+    {
+        return static_cast<std::size_t>(width()) * height();
+    }
+    Point operator[](std::size_t n) const
+    {
+        if (empty()) {
+            BOOST_THROW_EXCEPTION(std::out_of_range("operator[] cannot be called on empty PointRange."));
+        }
+        return Point(begin_.x + n % width(), begin_.y + n / width());
+    }
+
+    // The rows from first to last (exclusive), clipped to the range.
+    PointRange rows(int first, int last) const
+    {
+        first = std::max(first, begin_.y);
+        last = std::max(first, std::min(last, end_.y));
+        return PointRange(Point(begin_.x, first), Point(end_.x, last));
+    }
+    // At most count blocks of whole rows with about the same height.
+    std::vector<PointRange> splitRows(std::size_t count) const
+    {
+        std::vector<PointRange> result;
+        std::size_t rowCount = height();
+        count = std::min(count, rowCount);
+        for (std::size_t i = 0; i < count; ++i) {
+            result.push_back(rows(begin_.y + rowCount * i / count,
+                    begin_.y + rowCount * (i + 1) / count));
+        }
+        return result;
+    }
 }; // class PointRange
 
+// Holds the first and last column instead of pointing to the range, so it
+// stays valid after the range is gone.
 class PointRangeIterator: public boost::iterator_facade<
         PointRangeIterator,
         Point,
-        boost::bidirectional_traversal_tag,
+        boost::random_access_traversal_tag,
         Point > {
 public:
+    PointRangeIterator(): beginX_(0), endX_(0) {}
     PointRangeIterator(const PointRangeIterator&) = default;
     PointRangeIterator(PointRangeIterator&&) = default;
 
@@ -205,34 +334,53 @@ public:
     PointRangeIterator& operator=(PointRangeIterator&&) = default;
 
 private:
-    const PointRange* owner_;
     Point p_;
+    int beginX_;
+    int endX_;
 
     friend class PointRange;
     friend class boost::iterator_core_access;
 
-    PointRangeIterator(const PointRange& owner, Point  p):
-        owner_(&owner),
-        p_(p)
+    PointRangeIterator(Point p, int beginX, int endX):
+        p_(p),
+        beginX_(beginX),
+        endX_(endX)
     {}
     Point  dereference() const { return p_; }
     void increment()
     {
         ++p_.x;
-        if (p_.x == owner_->end_.x) {
-            p_.x = owner_->begin_.x;
+        if (p_.x == endX_) {
+            p_.x = beginX_;
             ++p_.y;
         }
     }
     void decrement()
     {
-        if (p_.x == owner_->begin_.x) {
-            p_.x = owner_->end_.x - 1;
+        if (p_.x == beginX_) {
+            p_.x = endX_ - 1;
             --p_.y;
         } else {
             --p_.x;
         }
     }
+    void advance(std::ptrdiff_t n)
+    {
+        std::ptrdiff_t width = endX_ - beginX_;
+        if (width == 0) {
+            return;
+        }
+        std::ptrdiff_t index = p_.x - beginX_ + n;
+        std::ptrdiff_t rows = index >= 0 ?
+                index / width : -((width - 1 - index) / width);
+        p_.y += rows;
+        p_.x = beginX_ + (index - rows * width);
+    }
+    std::ptrdiff_t distance_to(const PointRangeIterator& other) const
+    {
+        return static_cast<std::ptrdiff_t>(other.p_.y - p_.y) *
+                (endX_ - beginX_) + (other.p_.x - p_.x);
+    }
 
     bool equal(const PointRangeIterator& other) const
     {
@@ -243,15 +391,17 @@ private:
 inline
 PointRange::iterator PointRange::begin() const
 {
-    return iterator(*this, begin_);
+    return iterator(begin_, begin_.x, end_.x);
 }
 
 inline
 PointRange::iterator PointRange::end() const
 {
-    return iterator(*this, Point(begin_.x, end_.y));
+    return iterator(empty() ? begin_ : Point(begin_.x, end_.y), begin_.x,
+            end_.x);
 }
 
+
 // Matrix.hpp
 #include <boost/range/algorithm.hpp>
 #include <boost/serialization/vector.hpp>
@@ -282,6 +432,12 @@ public:
     Matrix(std::size_t width, std::size_t height, const T& defValue = T()):
         width_(width), height_(height), data_(width * height, defValue)
     {}
+    // Takes the cells in row-major order.
+    Matrix(std::size_t width, std::size_t height, Data&& data):
+        width_(width), height_(height), data_(std::move(data))
+    {
+        assert(data_.size() == width * height);
+    }
     Matrix(const Matrix& ) = default;
     Matrix(Matrix&& ) = default;
     Matrix& operator=(const Matrix& ) = default;
@@ -364,6 +520,16 @@ namespace std {
 template<typename T>
 struct hash<Matrix<T>> {
     size_t operator()(const Matrix<T>& arr) const {
+        return hashCells(arr, IsBytewiseHashable<T>{});
+    }
+
+private:
+    // The cells are contiguous in storage order.
+    size_t hashCells(const Matrix<T>& arr, std::true_type) const {
+        return arr.size() == 0 ? hashBytes(nullptr, 0) :
+                hashBytes(&arr[0], arr.size() * sizeof(T));
+    }
+    size_t hashCells(const Matrix<T>& arr, std::false_type) const {
         size_t seed = 0;
         for (size_t i = 0; i < arr.size(); ++i) {
             hash_combine(seed, arr[i]);
@@ -375,18 +541,17 @@ struct hash<Matrix<T>> {
 template <>
 struct hash<std::vector<Point>> {
     size_t operator()(const std::vector<Point>& arr) const {
-        size_t seed = 0;
-        for (size_t i = 0; i < arr.size(); ++i) {
-            hash_combine(seed, arr[i]);
-        }
-        return seed;
+        return hashBytes(arr.data(), arr.size() * sizeof(Point));
     }
 };
 
 }
 
+#include <algorithm>
 #include <iostream>
 #include <string>
+#include <type_traits>
+#include <utility>
 
 struct ToString {
     template<typename T>
@@ -400,41 +565,203 @@ struct ToString {
     }
 };
 
+struct DumpOptions {
+    std::string title;
+    int indent = 0;
+    // Every 5th and 10th row and column are highlighted with ANSI colours.
+    bool colour = true;
+    // If the matrix is larger, every printed cell stands for a block of
+    // cells and shows the largest value of the block, or the first one if
+    // the cells have no operator<. 0 means no limit.
+    std::size_t maxWidth = 0;
+    std::size_t maxHeight = 0;
+};
+
+namespace detail {
+
+inline
+std::size_t dumpBlockSize(std::size_t size, std::size_t maxSize) {
+    return maxSize == 0 || size <= maxSize ?
+            1 : (size + maxSize - 1) / maxSize;
+}
+
+template<typename T, typename = void>
+struct IsLessThanComparable: std::false_type {};
+
+template<typename T>
+struct IsLessThanComparable<T, decltype(void(
+        std::declval<const T&>() < std::declval<const T&>()))>:
+        std::true_type {};
+
+template<typename T>
+T dumpBlockValue(const Matrix<T>& table, Point begin, Point blockSize,
+        std::true_type /*isLessThanComparable*/) {
+    Point end{std::min<int>(begin.x + blockSize.x, table.width()),
+            std::min<int>(begin.y + blockSize.y, table.height())};
+    T result = table[begin];
+    for (Point p : PointRange{begin, end}) {
+        if (result < table[p]) {
+            result = table[p];
+        }
+    }
+    return result;
+}
+
+// Cells that cannot be compared show the first cell of the block.
+template<typename T>
+T dumpBlockValue(const Matrix<T>& table, Point begin,
+        Point /*blockSize*/, std::false_type /*isLessThanComparable*/) {
+    return table[begin];
+}
+
+template<typename Converter, typename T>
+std::size_t convertedSize(const Converter& converter, const T& value) {
+    return converter(value).size();
+}
+
+template<typename Converter, typename T>
+char* appendConverted(char* out, std::size_t width,
+        const Converter& converter, const T& value) {
+    std::string text = converter(value);
+    std::size_t padding = width - std::min(width, text.size());
+    std::fill_n(out, padding, ' ');
+    return std::copy(text.begin(), text.end(), out + padding);
+}
+
+// Integers are formatted in place without a temporary string.
+template<typename T>
+using EnableIfFormattedInPlace = typename std::enable_if<
+        std::is_integral<T>::value && !std::is_same<T, char>::value &&
+        !std::is_same<T, bool>::value>::type;
+
+template<typename T, typename = EnableIfFormattedInPlace<T>>
+std::size_t convertedSize(const ToString& /*converter*/, T value) {
+    // Division rounds towards zero, so this counts the digits of negative
+    // numbers too. Comparing with -10 would not work for unsigned T.
+    std::size_t result = value < 0 ? 2 : 1;
+    for (value /= 10; value != 0; value /= 10) {
+        ++result;
+    }
+    return result;
+}
+
+template<typename T, typename = EnableIfFormattedInPlace<T>>
+char* appendConverted(char* out, std::size_t width,
+        const ToString& /*converter*/, T value) {
+    // The digits are written backwards from the end of the cell. The
+    // width is always enough, it is the longest cell plus one.
+    char* end = out + width;
+    char* begin = end;
+    bool negative = value < 0;
+    do {
+        int digit = static_cast<int>(value % 10);
+        *--begin = '0' + (negative ? -digit : digit);
+        value /= 10;
+    } while (value != 0);
+    if (negative) {
+        *--begin = '-';
+    }
+    while (begin != out) {
+        *--begin = ' ';
+    }
+    return end;
+}
+
+inline
+char* appendText(char* out, const std::string& text) {
+    return std::copy(text.begin(), text.end(), out);
+}
+
+} // namespace detail
+
+// Formats the whole matrix into a single string.
 template<typename T, typename Converter = ToString>
-void dumpMatrix(std::ostream& file, const Matrix<T> table,
-        const std::string& title = "", int indent = 0,
+std::string renderMatrix(const Matrix<T>& table,
+        const DumpOptions& options = DumpOptions{},
         const Converter& converter = Converter{}) {
-    std::string indentString(indent, ' ');
-    if (!title.empty()) {
-        file << indentString << title << std::endl;
-    }
-    Matrix<std::string> txts(table.width(), table.height());
-    size_t maxlen = 0;
-    for (Point  p: matrixRange(table)) {
-        txts[p] = converter(table[p]);
-        maxlen = std::max(maxlen, txts[p].size());
+    Point blockSize(detail::dumpBlockSize(table.width(), options.maxWidth),
+            detail::dumpBlockSize(table.height(), options.maxHeight));
+    auto cellValue = [&](Point p) {
+            return blockSize == p11 ? table[p] : detail::dumpBlockValue(
+                    table, Point(p.x * blockSize.x, p.y * blockSize.y),
+                    blockSize, detail::IsLessThanComparable<T>{});
+        };
+    Point size((table.width() + blockSize.x - 1) / blockSize.x,
+            (table.height() + blockSize.y - 1) / blockSize.y);
+
+    std::size_t maxlen = 0;
+    for (Point p : PointRange{p00, size}) {
+        maxlen = std::max(maxlen, detail::convertedSize(converter,
+                cellValue(p)));
     }
     // leave a space between characters
     ++maxlen;
+
+    // The escapes have a constant length, so they are copied without a call.
+    static const char red[] = "\e[0;31m";
+    static const char yellow[] = "\e[0;33m";
+    static const char reset[] = "\e[0m";
+    constexpr std::size_t colourSize = sizeof(red) - 1;
+    constexpr std::size_t resetSize = sizeof(reset) - 1;
+    std::string indentString(options.indent, ' ');
+    std::string header;
+    if (!options.title.empty()) {
+        header += indentString + options.title + "\n";
+    }
+    if (blockSize != p11) {
+        header += indentString + "(" + std::to_string(blockSize.x) + "x" +
+                std::to_string(blockSize.y) + " blocks)\n";
+    }
+
+    // The exact size of the output, so that it is formatted in place.
+    std::size_t highlightedRows = (size.y + 4) / 5;
+    std::size_t highlightedCells = options.colour ?
+            highlightedRows * size.x +
+            (size.y - highlightedRows) * ((size.x + 4) / 5) : 0;
+    std::string result(header.size() +
+            size.y * (indentString.size() + size.x * maxlen + 1) + 1 +
+            highlightedCells * (colourSize + resetSize), '\0');
+    char* out = detail::appendText(&result[0], header);
     Point p;
-    for (p.y = 0; p.y < static_cast<int>(table.height()); p.y++) {
-        file << indentString;
-        for (p.x = 0; p.x < static_cast<int>(table.width()); p.x++) {
-            if (p.x % 10 == 0 || p.y % 10 == 0) {
-                file << "\e[0;31m";
-            } else if (p.x % 5 == 0 || p.y % 5 == 0) {
-                file << "\e[0;33m";
+    for (p.y = 0; p.y < size.y; p.y++) {
+        out = detail::appendText(out, indentString);
+        for (p.x = 0; p.x < size.x; p.x++) {
+            bool highlighted = options.colour &&
+                    (p.x % 5 == 0 || p.y % 5 == 0);
+            if (highlighted) {
+                out = std::copy_n(p.x % 10 == 0 || p.y % 10 == 0 ?
+                        red : yellow, colourSize, out);
             }
-            file.width(maxlen);
-            file << txts[p];
-            file.width(0);
-            if (p.x % 5 == 0 || p.y % 5 == 0) {
-                file << "\e[0m";
+            out = detail::appendConverted(out, maxlen, converter,
+                    cellValue(p));
+            if (highlighted) {
+                out = std::copy_n(reset, resetSize, out);
             }
         }
-        file << std::endl;
+        *out++ = '\n';
     }
-    file << std::endl;
+    *out++ = '\n';
+    assert(out == &result[0] + result.size());
+    return result;
+}
+
+// Writes the matrix with a single write.
+template<typename T, typename Converter = ToString>
+void dumpMatrix(std::ostream& file, const Matrix<T>& table,
+        const DumpOptions& options, const Converter& converter = Converter{}) {
+    std::string text = renderMatrix(table, options, converter);
+    file.write(text.data(), text.size());
+    file.flush();
+}
+
+template<typename T, typename Converter = ToString>
+void dumpMatrix(std::ostream& file, const Matrix<T>& table,
+        const std::string& title = "", int indent = 0,
+        const Converter& converter = Converter{}) {
+    DumpOptions options;
+    options.title = title;
+    options.indent = indent;
+    dumpMatrix(file, table, options, converter);
 }
 
 #include <boost/range/adaptor/transformed.hpp>
@@ -517,6 +844,48 @@ std::array<Point, 4> getAllNeigbors(Point p) {
     return {{p + p01, p - p01, p + p10, p - p10}};
 }
 
+// Neighbors.hpp
+typedef boost::container::static_vector<Point, 4> Neighbors;
+
+template<typename T>
+Neighbors getNeigbors(const Matrix<T>& m, Point p) {
+    Neighbors result;
+    for (Point n : getAllNeigbors(p)) {
+        if (isInsideMatrix(m, n)) {
+            result.push_back(n);
+        }
+    }
+    return result;
+}
+
+template<typename T>
+std::array<Point, 4> getAllNeigbors(const Matrix<T>& /*m*/, Point p) {
+    return getAllNeigbors(p);
+}
+
+// Neigbors having the value, those outside the matrix are 0
+template<typename T>
+Neighbors getAllNeigbors(const Matrix<T>& m, Point p, const T& value) {
+    Neighbors result;
+    for (Point n : getAllNeigbors(p)) {
+        if (matrixAt(m, n, T{}) == value) {
+            result.push_back(n);
+        }
+    }
+    return result;
+}
+
+template<typename T>
+Neighbors getAllNeigbors_not(const Matrix<T>& m, Point p, const T& value) {
+    Neighbors result;
+    for (Point n : getAllNeigbors(p)) {
+        if (matrixAt(m, n, T{}) != value) {
+            result.push_back(n);
+        }
+    }
+    return result;
+}
+
 std::ostream& operator<<(std::ostream& os, const std::vector<Point>& ps) {
     for (const auto& p : ps) {
         os << p;
@@ -580,8 +949,12 @@ Finally<Function> finally(const Function& function)
 #include <random>
 #include <vector>
 
-template<typename Iterator>
-void doBuild(Matrix<int>& mx, Iterator begin, Iterator end) {
+// A board with a byte for each cell.
+typedef Matrix<std::uint8_t> PackedBoard;
+
+// The cells of mx must be between 0 and 4.
+template<typename T, typename Iterator>
+void doBuild(Matrix<T>& mx, Iterator begin, Iterator end) {
     for (;begin != end; ++begin) {
         auto p = *begin;
         mx[p] = 1;
@@ -589,8 +962,8 @@ void doBuild(Matrix<int>& mx, Iterator begin, Iterator end) {
         for (const auto n : getAllNeigbors(p)) {
             if (isInsideMatrix(mx, n)) {
                 auto& v = mx[n];
-                if (v >= 1) ++v;
-                if (v > 4) v = 1;
+                // 0 stays 0, 1-3 are incremented and 4 becomes 1.
+                v = (v & 3) + (v != 0);
             }
         }
     }
@@ -602,7 +975,14 @@ Matrix<int> build(int m, int n, const std::vector<Point>& ps) {
     return mx;
 }
 
-Matrix<int> generate(int m, int n) {
+PackedBoard buildPacked(int m, int n, const std::vector<Point>& ps) {
+    PackedBoard mx(m, n);
+    doBuild(mx, ps.begin(), ps.end());
+    return mx;
+}
+
+// The same seed gives the same board.
+Matrix<int> generate(int m, int n, unsigned seed) {
     //std::vector<std::vector<int>> result;
 
     std::vector<Point> ps;
@@ -612,13 +992,17 @@ Matrix<int> generate(int m, int n) {
         }
     }
 
-    std::random_device rd;
-    std::mt19937 g(rd());
+    std::mt19937 g(seed);
     std::shuffle(ps.begin(), ps.end(), g);
 
     return build(m, n, ps);
 }
 
+Matrix<int> generate(int m, int n) {
+    std::random_device rd;
+    return generate(m, n, rd());
+}
+
 namespace pair {
 
 Matrix<int> build(int m, int n, const std::vector<Point>& ps) {
@@ -629,15 +1013,15 @@ Matrix<int> build(int m, int n, const std::vector<Point>& ps) {
         for (const auto n : getAllNeigbors(p)) {
             if (isInsideMatrix(mx, n)) {
                 auto& v = mx[n];
-                if (v >= 1) ++v;
+                v += (v != 0);
             }
         }
     }
     return mx;
 }
 
-// <diag, original>
-std::pair<Matrix<int>, Matrix<int>> generate(int m, int n) {
+// <diag, original>. The same seed gives the same boards.
+std::pair<Matrix<int>, Matrix<int>> generate(int m, int n, unsigned seed) {
     //std::vector<std::vector<int>> result;
 
     std::vector<Point> ps;
@@ -647,8 +1031,7 @@ std::pair<Matrix<int>, Matrix<int>> generate(int m, int n) {
         }
     }
 
-    std::random_device rd;
-    std::mt19937 g(rd());
+    std::mt19937 g(seed);
     std::shuffle(ps.begin(), ps.end(), g);
 
     auto first = pair::build(m, n, ps);
@@ -659,10 +1042,103 @@ std::pair<Matrix<int>, Matrix<int>> generate(int m, int n) {
     return {first, second};
 }
 
+std::pair<Matrix<int>, Matrix<int>> generate(int m, int n) {
+    std::random_device rd;
+    return generate(m, n, rd());
+}
+
 }
 
+bool sameBoard(const PackedBoard& board, const Matrix<int>& expected) {
+    if (board.size() != expected.size()) {
+        return false;
+    }
+    // No early exit, so that the loop can be vectorized.
+    int diff = 0;
+    for (std::size_t i = 0; i < board.size(); ++i) {
+        diff |= board[i] ^ expected[i];
+    }
+    return diff == 0;
+}
+
+// Checks the rows [begin, end) of expected. times is the build time of each
+// cell plus one, 0 for the cells not built, with a border of 0s.
+bool checkRows(const Matrix<std::uint32_t>& times,
+               const Matrix<int>& expected,
+               std::size_t begin, std::size_t end) {
+    const std::size_t width = expected.width();
+    const std::size_t stride = times.width();
+    int diff = 0;
+    for (std::size_t y = begin; y < end; ++y) {
+        const std::uint32_t* t = &times[(y + 1) * stride + 1];
+        const int* e = &expected[y * width];
+        for (std::size_t x = 0; x < width; ++x) {
+            std::uint32_t c = t[x];
+            int later = (t[x - 1] > c) + (t[x + 1] > c) +
+                    (t[x - stride] > c) + (t[x + stride] > c);
+            int v = (c != 0) * ((later & 3) + 1);
+            diff |= v ^ e[x];
+        }
+    }
+    return diff == 0;
+}
+
+// The number of threads check() uses, 0 for one per core.
+unsigned checkThreads = 0;
+
+// A built cell is 1 plus the number of its neighbors built after it, wrapped
+// to 1-4, and the cells not built are 0. So when every cell is built at most
+// once, the rows can be checked in parallel from the build times, without
+// building the board.
 bool check(const std::vector<Point>& ps, const Matrix<int>& expected) {
-    return build(expected.width(), expected.height(), ps) == expected;
+    if (expected.size() == 0) {
+        return ps.empty();
+    }
+    Matrix<std::uint32_t> times(expected.width() + 2, expected.height() + 2);
+    for (std::size_t i = 0; i < ps.size(); ++i) {
+        if (!isInsideMatrix(expected, ps[i])) {
+            return false;
+        }
+        auto& t = times[ps[i] + p11];
+        if (t != 0) {
+            return sameBoard(buildPacked(expected.width(), expected.height(),
+                                         ps), expected);
+        }
+        t = i + 1;
+    }
+
+    const std::size_t height = expected.height();
+    std::size_t numThreads = checkThreads != 0 ? checkThreads
+            : std::max(std::thread::hardware_concurrency(), 1u);
+    // Threads are not worth starting for small boards.
+    numThreads = std::max<std::size_t>(
+            std::min(numThreads, expected.size() / (1 << 16)), 1);
+    numThreads = std::min(numThreads, height);
+    std::vector<char> results(numThreads);
+    auto checkBand = [&](std::size_t band) {
+        results[band] = checkRows(times, expected,
+                height * band / numThreads, height * (band + 1) / numThreads);
+    };
+    std::vector<std::thread> threads;
+    auto joinThreads = [&threads]() {
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    };
+    try {
+        for (std::size_t band = 1; band < numThreads; ++band) {
+            threads.emplace_back(checkBand, band);
+        }
+        checkBand(0);
+    } catch (...) {
+        // The bands that started use results, and destroying a running
+        // thread terminates the program.
+        joinThreads();
+        throw;
+    }
+    joinThreads();
+    return std::all_of(results.begin(), results.end(),
+                       [](char result) { return result; });
 }
 
 
@@ -670,66 +1146,162 @@ bool check(const std::vector<Point>& ps, const Matrix<int>& expected) {
 //==============================================================================
 // SOLUTION COMES FROM HERE
 
-int floodErrors = 0;
-
-bool flood(std::vector<Point> st, Matrix<int>& m,
-                std::vector<Point>& path) {
-    std::vector<Point> nst;
-    while (!st.empty()) {
-        auto p = st.back();
-        st.pop_back();
-        if (m[p] != 1 ) { continue; }
-
-        m[p] = 0;
-        path.push_back(p);
-        auto ns = getAllNeigbors(p);
-        for (const auto& n : ns) {
-            if (isInsideMatrix(m, n)) {
-                --m[n];
-                if (m[n] == 0) {
-                    m[n] = 4;
-                }
-                if (m[n] < 0) m[n] = 0;
-                if (m[n] == 1) nst.push_back(n);
-            }
+// How much solve() had to backtrack.
+struct SolveStats {
+    // Branches of the exhaustive search that were undone.
+    int falsePaths = 0;
+    // Floods stopped because a cell could not be built anymore.
+    int floodErrors = 0;
+    // Searches for the 1s inside that found a cell that cannot be built.
+    int get1sErrors = 0;
+    // Cells whose order to all of their neighbors propagation found before
+    // the exhaustive search.
+    int decidedCells = 0;
+
+    SolveStats& operator+=(const SolveStats& other) {
+        falsePaths += other.falsePaths;
+        floodErrors += other.floodErrors;
+        get1sErrors += other.get1sErrors;
+        decidedCells += other.decidedCells;
+        return *this;
+    }
+};
+
+enum class SolveStatus {
+    solved,
+    // The deadline passed before every island was solved.
+    timedOut,
+    // The search tried everything for an island.
+    failed
+};
+
+typedef std::chrono::steady_clock Clock;
+
+// The time solve() has to give up at. The islands solved in parallel share
+// it, so once it has passed, every thread stops.
+class Deadline {
+public:
+    explicit Deadline(Clock::time_point time) : time_(time), expired_(false) {}
+
+    bool expired() {
+        if (!expired_ && time_ != Clock::time_point::max() &&
+                Clock::now() >= time_) {
+            expired_ = true;
         }
+        return expired_;
+    }
 
-        // Cut offs
-        for (const auto& n : ns) {
-            if (!isInsideMatrix(m, n)) {
-                continue;
+private:
+    Clock::time_point time_;
+    std::atomic<bool> expired_;
+};
+
+// The old values of the changed cells of a board, so that the changes can be
+// undone back to a mark.
+class BoardJournal {
+public:
+    std::size_t mark() const { return entries_.size(); }
+
+    void record(const Matrix<int>& m, std::size_t i) {
+        entries_.emplace_back(i, m[i]);
+    }
+
+    // The cells changed since the mark, each as many times as it was changed.
+    template<typename Function>
+    void forEachChanged(std::size_t mark, const Function& function) const {
+        for (std::size_t k = mark; k < entries_.size(); ++k) {
+            function(entries_[k].first);
+        }
+    }
+
+    void rewind(Matrix<int>& m, std::size_t mark) {
+        while (entries_.size() > mark) {
+            m[entries_.back().first] = entries_.back().second;
+            entries_.pop_back();
+        }
+    }
+
+    // Makes the changes final, there must be no marks taken before.
+    void clear() {
+        entries_.clear();
+    }
+
+private:
+    std::vector<std::pair<std::size_t, int>> entries_;
+};
+
+// Removes the 1s in st and every cell that becomes 1 because of that. The
+// worklist holds linear indices and is used as a stack, so the cells are
+// removed in the same depth first order as when flood() called itself for the
+// new 1s. Returns false when a neighbor of a removed cell cannot be built
+// anymore, which the callers count as a flood error. If there is a journal,
+// every change is recorded in it. A flood over a big board takes long, so it
+// also stops with false when the deadline passes. The cells removed until
+// then are still a valid path.
+bool flood(const std::vector<Point>& st, Matrix<int>& m,
+                std::vector<Point>& path, BoardJournal* journal = nullptr,
+                Deadline* deadline = nullptr) {
+    if (m.size() == 0) {
+        return true;
+    }
+    thread_local std::vector<std::size_t> worklist;
+    worklist.clear();
+    const std::size_t width = m.width();
+    const std::size_t height = m.height();
+    for (const auto& p : st) {
+        worklist.push_back(p.y * width + p.x);
+    }
+
+    int* cells = &m[0];
+    while (!worklist.empty()) {
+        std::size_t i = worklist.back();
+        worklist.pop_back();
+        if (cells[i] != 1) { continue; }
+        if (deadline && path.size() % 4096 == 0 && deadline->expired()) {
+            return false;
+        }
+
+        if (journal) journal->record(m, i);
+        cells[i] = 0;
+        std::size_t x = i % width;
+        std::size_t y = i / width;
+        path.emplace_back(x, y);
+
+        // The same order as getAllNeigbors().
+        std::size_t ns[4];
+        std::size_t count = 0;
+        if (y + 1 < height) ns[count++] = i + width;
+        if (y > 0) ns[count++] = i - width;
+        if (x + 1 < width) ns[count++] = i + 1;
+        if (x > 0) ns[count++] = i - 1;
+
+        for (std::size_t k = 0; k < count; ++k) {
+            if (journal) journal->record(m, ns[k]);
+            int& v = cells[ns[k]];
+            --v;
+            if (v == 0) {
+                v = 4;
             }
+            if (v < 0) v = 0;
+            if (v == 1) worklist.push_back(ns[k]);
+        }
 
-            auto nns = getAllNeigbors(n);
-            std::size_t nsize = std::count_if(nns.begin(), nns.end(),
-                    [&](Point p) { return isInsideMatrix(m, p); });
-            //auto sum_nns = 0;
-            //for (const auto& nn : nns) {
-                //sum_nns += m[nn];
-            //}
-            //if (sum_nns < m[n] - 1) {
-                //std::cout << "FLOOD ERROR\n";
-                //return false;
-            //}
+        // Cut offs
+        for (std::size_t k = 0; k < count; ++k) {
+            std::size_t nx = ns[k] % width;
+            std::size_t ny = ns[k] / width;
+            int nsize = (nx > 0) + (nx + 1 < width) + (ny > 0) +
+                    (ny + 1 < height);
+            int v = cells[ns[k]];
 
             // elszigetelt 2-es vagy annal nagyobb
-            if (m[n] >= 2 && nsize == 0) {
-                ++floodErrors;
-                return false;
-            }
             // - 3-as vagy 4-es aminek 1 szomszedja van.
-            if (m[n] >= 3 && nsize == 1) {
-                ++floodErrors;
-                return false;
-            }
             // - 4-es aminek 2 szomszedja van.
-            if (m[n] >= 4 && nsize == 2) {
-                ++floodErrors;
+            if ((v >= 2 && nsize == 0) || (v >= 3 && nsize == 1) ||
+                    (v >= 4 && nsize == 2)) {
                 return false;
             }
         }
-
-        if (!flood(nst, m, path)) { return false; }
     }
     return true;
 }
@@ -777,9 +1349,13 @@ int solve_exp_called = 0;
 
 
 bool get_1s_inside_loop(const Matrix<int>& m, const Point p,
-                        std::vector<Point> H, std::vector<Point>& result/*,
-                        int depth*/) {
-    H.push_back(p);
+                        std::vector<Point>& H, std::vector<Point>& result,
+                        std::vector<Point>& visited);
+
+// H is the path of the search to p, without p.
+bool get_1s_inside_step(const Matrix<int>& m, const Point p,
+                        std::vector<Point>& H, std::vector<Point>& result,
+                        std::vector<Point>& visited) {
     auto sum0s = 0;
     for (auto x : getAllNeigbors(p)) {
         if (matrixAt(m, x, 0) == 0 ||
@@ -806,24 +1382,36 @@ bool get_1s_inside_loop(const Matrix<int>& m, const Point p,
             //std::cerr << "Adding: " << n << "\n";
             result.push_back(n);
         } else {
-            if (!get_1s_inside_loop(m, n, H, result/*, depth + 1*/)) {
+            if (!get_1s_inside_loop(m, n, H, result, visited)) {
                 return false;
             }
         }
     }
     return true;
-};
+}
 
-int get1sErrors = 0;
+// Collects the 1s that must be built before p into result. H is shared by
+// the whole search, every level removes what it added. The cells whose
+// neighbors were read are added to visited.
+bool get_1s_inside_loop(const Matrix<int>& m, const Point p,
+                        std::vector<Point>& H, std::vector<Point>& result,
+                        std::vector<Point>& visited) {
+    H.push_back(p);
+    visited.push_back(p);
+    bool ok = get_1s_inside_step(m, p, H, result, visited);
+    H.pop_back();
+    return ok;
+}
 
 boost::optional<std::vector<Point>> get_1s_inside(const Matrix<int>& m) {
     std::vector<Point> result;
+    std::vector<Point> H;
+    std::vector<Point> visited;
     for (int i = 0; i < m.height(); ++i) {
         for (int j = 0; j < m.width(); ++j) {
-            std::vector<Point> H;
             Point p{j, i};
-            if (!get_1s_inside_loop(m, p, H, result/*, 0*/)) {
-                ++get1sErrors;
+            visited.clear();
+            if (!get_1s_inside_loop(m, p, H, result, visited)) {
                 return boost::none;
             }
         }
@@ -831,18 +1419,212 @@ boost::optional<std::vector<Point>> get_1s_inside(const Matrix<int>& m) {
     return result;
 }
 
-int numFalsePaths = 0;
+// The same as get_1s_inside() for a board that changes only a little
+// between the calls. The 1s found from each cell are kept, and after a flood
+// only the cells whose search read a changed cell are searched again.
+class InsideOnes {
+public:
+    // Searching from every cell of a big board takes long, so it stops when
+    // the deadline passes. Then only the destructor may be called.
+    explicit InsideOnes(const Matrix<int>& m, Deadline* deadline = nullptr) :
+        m_(m), failed_(m.size()), numFailed_(0), numReaders_(m.size()),
+        changedMark_(m.size()), dirty_(m.size()) {
+        for (std::size_t i = 0; i < m_.size(); ++i) {
+            if (deadline && i % 4096 == 0 && deadline->expired()) {
+                return;
+            }
+            search(i);
+        }
+    }
 
-bool solve_exp_flood_first(std::vector<Point> S, Matrix<int>& m,
-                           size_t size,
-                           std::vector<Point> path,
-                           std::vector<Point>& result) {
+    // The value of the cell i has changed since the last get().
+    void changed(std::size_t i) {
+        if (!changedMark_[i]) {
+            changedMark_[i] = true;
+            changed_.push_back(i);
+        }
+    }
 
-    auto flooood = [size](Matrix<int>&m, std::vector<Point>& path){
-        while (size != path.size()) {
+    // The cells of path from index `from` on were removed by flood(), which
+    // also changed their neighbors.
+    void removed(const std::vector<Point>& path, std::size_t from) {
+        for (std::size_t k = from; k < path.size(); ++k) {
+            Point c = path[k];
+            changed(index(c));
+            for (auto n : getAllNeigbors(c)) {
+                if (isInsideMatrix(m_, n)) {
+                    changed(index(n));
+                }
+            }
+        }
+    }
 
-            auto st = get_1s_inside(m);
+    boost::optional<std::vector<Point>> get() {
+        refresh();
+        if (numFailed_ != 0) {
+            return boost::none;
+        }
+        std::vector<Point> result;
+        for (const auto& cell : found_) {
+            result.insert(result.end(), cell.second.begin(),
+                    cell.second.end());
+        }
+        return result;
+    }
+
+private:
+    std::size_t index(Point p) const {
+        return p.y * m_.width() + p.x;
+    }
+
+    // Searches again from every cell that read a changed cell: those that
+    // visited it or one of its neighbors. A big flood changes the same cells
+    // many times and they share their readers, so the cells are marked
+    // instead of sorting every mention.
+    void refresh() {
+        auto addDirty = [this](std::size_t i) {
+            if (!dirty_[i]) {
+                dirty_[i] = true;
+                toSearch_.push_back(i);
+            }
+        };
+        auto addReaders = [&](std::size_t i) {
+            addDirty(i);
+            if (numReaders_[i] == 0) {
+                return;
+            }
+            for (std::size_t reader : visitedBy_.at(i)) {
+                addDirty(reader);
+            }
+        };
+        for (std::size_t i : changed_) {
+            changedMark_[i] = false;
+            addReaders(i);
+            Point c(i % m_.width(), i / m_.width());
+            for (auto n : getAllNeigbors(c)) {
+                if (isInsideMatrix(m_, n)) {
+                    addReaders(index(n));
+                }
+            }
+        }
+        changed_.clear();
+        std::sort(toSearch_.begin(), toSearch_.end());
+        forget();
+        for (std::size_t i : toSearch_) {
+            dirty_[i] = false;
+            search(i);
+        }
+        toSearch_.clear();
+    }
+
+    void search(std::size_t i) {
+        Point p(i % m_.width(), i / m_.width());
+        H_.clear();
+        result_.clear();
+        visited_.clear();
+        if (!get_1s_inside_loop(m_, p, H_, result_, visited_)) {
+            failed_[i] = true;
+            ++numFailed_;
+        } else if (!result_.empty()) {
+            found_.emplace(i, result_);
+        }
+        // A search that stayed at p only read p and its neighbors.
+        if (visited_.size() > 1) {
+            std::vector<std::size_t>& cells = visits_[i];
+            for (auto v : visited_) {
+                cells.push_back(index(v));
+            }
+            std::sort(cells.begin(), cells.end());
+            cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+            for (auto v : cells) {
+                visitedBy_[v].push_back(i);
+                ++numReaders_[v];
+            }
+        }
+    }
+
+    // Drops what the searches from the dirty cells found. They are taken
+    // out of the readers of what they visited in one pass for each visited
+    // cell, because after a big flood most of the readers of a cell are
+    // dirty.
+    void forget() {
+        stale_.clear();
+        for (std::size_t i : toSearch_) {
+            if (failed_[i]) {
+                failed_[i] = false;
+                --numFailed_;
+            } else {
+                found_.erase(i);
+            }
+            auto it = visits_.find(i);
+            if (it != visits_.end()) {
+                stale_.insert(stale_.end(), it->second.begin(),
+                        it->second.end());
+                visits_.erase(it);
+            }
+        }
+        std::sort(stale_.begin(), stale_.end());
+        stale_.erase(std::unique(stale_.begin(), stale_.end()), stale_.end());
+        for (std::size_t v : stale_) {
+            auto it = visitedBy_.find(v);
+            auto& readers = it->second;
+            readers.erase(std::remove_if(readers.begin(), readers.end(),
+                    [this](std::size_t i) { return dirty_[i]; }),
+                    readers.end());
+            numReaders_[v] = readers.size();
+            if (readers.empty()) {
+                visitedBy_.erase(it);
+            }
+        }
+    }
+
+    const Matrix<int>& m_;
+    // Ordered by cell, so the 1s come in the order of get_1s_inside().
+    std::map<std::size_t, std::vector<Point>> found_;
+    std::vector<bool> failed_;
+    std::size_t numFailed_;
+    // The cells searched from more than one cell, both ways. numReaders_
+    // saves the lookup for the cells that no such search visited.
+    std::unordered_map<std::size_t, std::vector<std::size_t>> visits_;
+    std::unordered_map<std::size_t, std::vector<std::size_t>> visitedBy_;
+    std::vector<unsigned> numReaders_;
+    std::vector<bool> changedMark_, dirty_;
+    std::vector<std::size_t> changed_, toSearch_, stale_;
+    std::vector<Point> H_, result_, visited_;
+};
+
+// The state shared by every level of solve_exp_flood_first(). A level adds
+// its flood to the end of path and to the journal, and takes both back when
+// the branch fails.
+struct FloodSearch {
+    Matrix<int>& m;
+    size_t size;
+    std::vector<Point>& path;
+    BoardJournal journal;
+    InsideOnes insideOnes;
+    Deadline& deadline;
+    SolveStats stats;
+
+    FloodSearch(Matrix<int>& m, size_t size, std::vector<Point>& path,
+                Deadline& deadline)
+        : m(m), size(size), path(path), insideOnes(m, &deadline),
+          deadline(deadline) {}
+
+    // Floods from st, then from the 1s inside until there are none. Only the
+    // cells flooded here count for the size. Gives up when the deadline
+    // passes, because the first floods on a big island can take long.
+    bool allFlood(const std::vector<Point>& st) {
+        std::size_t start = path.size();
+        if (!flood(st)) {
+            return false;
+        }
+        while (size != path.size() - start) {
+            if (deadline.expired()) {
+                return false;
+            }
+            auto st = insideOnes.get();
             if (!st) {
+                ++stats.get1sErrors;
                 return false;
             }
             // check_if_really_1(diag, st);
@@ -851,45 +1633,290 @@ bool solve_exp_flood_first(std::vector<Point> S, Matrix<int>& m,
                 break;
             }
 
-            if (!flood(*st, m, path)) {
+            if (!flood(*st)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool flood(const std::vector<Point>& st) {
+        std::size_t mark = journal.mark();
+        bool result = ::flood(st, m, path, &journal, &deadline);
+        if (deadline.expired()) {
+            return false;
+        }
+        if (!result) {
+            ++stats.floodErrors;
+        }
+        journal.forEachChanged(mark, [this](std::size_t i) {
+            insideOnes.changed(i);
+        });
+        return result;
+    }
+
+    // Once the deadline has passed, the board is not used anymore, so only
+    // the path is taken back.
+    void undo(std::size_t pathSize, std::size_t mark) {
+        if (!deadline.expired()) {
+            journal.forEachChanged(mark, [this](std::size_t i) {
+                insideOnes.changed(i);
+            });
+            journal.rewind(m, mark);
+        }
+        path.resize(pathSize);
+    }
+};
+
+// Tries the candidates S[0, k) from the back. A candidate is flooded and the
+// rest are tried after it; if that fails, it is undone and skipped. Gives up
+// when the deadline passes.
+bool solve_exp_flood_first(const std::vector<Point>& S, std::size_t k,
+                           FloodSearch& search) {
+    while (true) {
+        if (search.path.size() == search.size) {
+            return true;
+        }
+        if (k == 0 || search.deadline.expired()) return false;
+
+        auto p = S[--k];
+        std::size_t pathSize = search.path.size();
+        std::size_t mark = search.journal.mark();
+
+        if (search.allFlood({p}) && solve_exp_flood_first(S, k, search)) {
+            return true;
+        }
+        search.undo(pathSize, mark);
+        if (search.deadline.expired()) return false;
+        ++search.stats.falsePaths;
+    }
+}
+
+// Propagates the rules of auto_predicates.hpp on the order in which
+// neighboring cells were built. A cell of value v was built before k of its
+// remaining neighbors, where k is v - 1 or v + 3 and at most the number of
+// those neighbors. The order of each pair of neighbors is a variable. When
+// the pairs already known leave only one choice for the unknown pairs of a
+// cell, they are fixed, and the cells on their other ends are checked again.
+class Propagator {
+public:
+    explicit Propagator(const Matrix<int>& m)
+        : m_(m), orders_(2 * m.size(), unknown), queued_(m.size(), false) {
+        for (std::size_t i = 0; i < m_.size(); ++i) {
+            changed(i);
+        }
+    }
+
+    // Checks the cell again, because it or its neighbors changed.
+    void changed(std::size_t i) {
+        if (!queued_[i]) {
+            queued_[i] = true;
+            dirty_.push_back(i);
+        }
+    }
+
+    // Returns false if the cells cannot be built in any order, or if the
+    // deadline passes first.
+    bool propagate(Deadline& deadline) {
+        for (std::size_t n = 1; !dirty_.empty(); ++n) {
+            if (n % 4096 == 0 && deadline.expired()) {
                 return false;
             }
+            std::size_t i = dirty_.back();
+            dirty_.pop_back();
+            queued_[i] = false;
+            if (!update(i)) {
+                return false;
+            }
+            if (m_[i] == 1 && isLast(i)) {
+                last_.push_back(i);
+            }
         }
         return true;
+    }
+
+    // The 1s found by propagate() since the last call that were built after
+    // all of their neighbors.
+    std::vector<Point> takeLast() {
+        std::vector<Point> result;
+        std::sort(last_.begin(), last_.end());
+        last_.erase(std::unique(last_.begin(), last_.end()), last_.end());
+        for (std::size_t i : last_) {
+            if (m_[i] == 1 && isLast(i)) {
+                result.emplace_back(i % m_.width(), i / m_.width());
+            }
+        }
+        last_.clear();
+        return result;
+    }
+
+    // Every remaining neighbor of i was built before it.
+    bool isLast(std::size_t i) const {
+        Count count = countNeighbors(i);
+        return count.after == 0 && count.unknown == 0;
+    }
+
+    // The order of i and each of its remaining neighbors is known.
+    bool isDecided(std::size_t i) const {
+        return countNeighbors(i).unknown == 0;
+    }
+
+private:
+    // The order of a pair, i is the upper or left cell.
+    enum Order : std::int8_t { unknown, firstBuiltFirst, secondBuiltFirst };
+
+    // The pair of i and i + 1 is orders_[2 * i], the pair of i and
+    // i + width is orders_[2 * i + 1].
+    struct Neighbors {
+        std::size_t cells[4];
+        std::size_t pairs[4];
+        bool first[4];
+        std::size_t size = 0;
     };
 
-    auto allFlood = [flooood](std::vector<Point> st, Matrix<int>&m, std::vector<Point>& path) {
-        return flood(st, m, path) && flooood(m, path);
+    struct Count {
+        int after = 0;
+        int unknown = 0;
+        int remaining = 0;
     };
 
-    if (path.size() == size) {
-        result = path;
-        return true;
+    // The remaining neighbors of i.
+    Neighbors neighbors(std::size_t i) const {
+        const std::size_t width = m_.width();
+        std::size_t x = i % width;
+        Neighbors result;
+        auto add = [&](std::size_t n, std::size_t pair, bool first) {
+            if (m_[n] != 0) {
+                result.cells[result.size] = n;
+                result.pairs[result.size] = pair;
+                result.first[result.size] = first;
+                ++result.size;
+            }
+        };
+        // The same order as getAllNeigbors().
+        if (i + width < m_.size()) add(i + width, 2 * i + 1, true);
+        if (i >= width) add(i - width, 2 * (i - width) + 1, false);
+        if (x + 1 < width) add(i + 1, 2 * i, true);
+        if (x > 0) add(i - 1, 2 * (i - 1), false);
+        return result;
     }
-    if (S.empty()) return false;
 
-    auto p = S.back();
-    S.pop_back();
+    // Whether the neighbor is built after the cell, which is the first of
+    // the pair or not.
+    static bool builtAfter(std::int8_t order, bool first) {
+        return order == (first ? firstBuiltFirst : secondBuiltFirst);
+    }
 
+    Count countNeighbors(std::size_t i) const {
+        Count count;
+        Neighbors ns = neighbors(i);
+        count.remaining = ns.size;
+        for (std::size_t j = 0; j < ns.size; ++j) {
+            std::int8_t order = orders_[ns.pairs[j]];
+            if (order == unknown) {
+                ++count.unknown;
+            } else if (builtAfter(order, ns.first[j])) {
+                ++count.after;
+            }
+        }
+        return count;
+    }
 
-    std::vector<Point> floodpath;
+    bool update(std::size_t i) {
+        int v = m_[i];
+        if (v == 0) {
+            return true;
+        }
+        Count count = countNeighbors(i);
+        auto possible = [&](int k) {
+            return k >= count.after && k <= count.after + count.unknown;
+        };
+        bool low = possible(v - 1), high = possible(v + 3);
+        if (!low && !high) {
+            return false;
+        }
+        if (count.unknown == 0 || (low && high)) {
+            return true;
+        }
+        int k = low ? v - 1 : v + 3;
+        bool after;
+        if (k == count.after) {
+            after = false;
+        } else if (k == count.after + count.unknown) {
+            after = true;
+        } else {
+            return true;
+        }
+        Neighbors ns = neighbors(i);
+        for (std::size_t j = 0; j < ns.size; ++j) {
+            std::int8_t& order = orders_[ns.pairs[j]];
+            if (order == unknown) {
+                // i is built first if the neighbor is built after it.
+                order = after == ns.first[j] ? firstBuiltFirst
+                                             : secondBuiltFirst;
+                changed(ns.cells[j]);
+            }
+        }
+        return true;
+    }
 
-    if (!allFlood({p}, m, floodpath)) {
-        doBuild(m, floodpath.rbegin(), floodpath.rend());
-        ++numFalsePaths;
-        return solve_exp_flood_first(S, m, size, path, result);
+    const Matrix<int>& m_;
+    std::vector<std::int8_t> orders_;
+    std::vector<bool> queued_;
+    std::vector<std::size_t> dirty_, last_;
+};
+
+// Removes the 1s that propagation shows were built after all of their
+// neighbors, then what flooding from them removes, until there are none.
+// These are in every solution, so they are not undone. Returns false if
+// there is no solution.
+bool propagate_forced(FloodSearch& search) {
+    const Matrix<int>& m = search.m;
+    Propagator propagator{m};
+    std::size_t start = search.path.size();
+    while (true) {
+        if (!propagator.propagate(search.deadline) ||
+                search.deadline.expired()) {
+            return false;
+        }
+        auto last = propagator.takeLast();
+        if (last.empty()) {
+            break;
+        }
+        if (!search.allFlood(last)) {
+            return false;
+        }
+        search.journal.forEachChanged(0, [&](std::size_t i) {
+            propagator.changed(i);
+        });
+        search.journal.clear();
     }
-    if (!solve_exp_flood_first(S, m, size, concat(path, floodpath), result)) {
-        doBuild(m, floodpath.rbegin(), floodpath.rend());
-        ++numFalsePaths;
-        return solve_exp_flood_first(S, m, size, path, result);
+    search.stats.decidedCells += search.path.size() - start;
+    for (std::size_t i = 0; i < m.size(); ++i) {
+        if (m[i] != 0 && propagator.isDecided(i)) {
+            ++search.stats.decidedCells;
+        }
     }
     return true;
 }
 
-bool solve_exp_flood_first(std::vector<Point> S, Matrix<int> m, size_t size,
-                           std::vector<Point>& path) {
-    return solve_exp_flood_first(S, m, size, path, path);
+bool solve_exp_flood_first(const std::vector<Point>& S, Matrix<int> m,
+                           size_t size, std::vector<Point>& path,
+                           Deadline& deadline, SolveStats& stats) {
+    FloodSearch search{m, size, path, deadline};
+    bool result = !deadline.expired() && propagate_forced(search);
+    if (result) {
+        // Those removed already or not 1 anymore are not worth trying.
+        std::vector<Point> candidates;
+        for (Point p : S) {
+            if (m[p] == 1) {
+                candidates.push_back(p);
+            }
+        }
+        result = solve_exp_flood_first(candidates, candidates.size(), search);
+    }
+    stats += search.stats;
+    return result;
 }
 
 void check_if_really_1 (const Matrix<int>& diag, const std::vector<Point>& st){
@@ -904,11 +1931,20 @@ void check_if_really_1 (const Matrix<int>& diag, const std::vector<Point>& st){
 void get_group_impl(const Matrix<int>& m, Point p, int value,
                Matrix<bool>& marked,
                std::vector<Point>& result) {
+    std::vector<Point> stack{p};
     marked[p] = true;
-    result.push_back(p);
-    for (auto n : getAllNeigbors(p)) {
-        if(isInsideMatrix(m, n) && !marked[n] && m[n] == value) {
-            get_group_impl(m, n, value, marked, result);
+    while (!stack.empty()) {
+        Point q = stack.back();
+        stack.pop_back();
+        result.push_back(q);
+        auto ns = getAllNeigbors(q);
+        // Backwards, so that the first neighbor is the next one.
+        for (auto it = ns.rbegin(); it != ns.rend(); ++it) {
+            Point n = *it;
+            if(isInsideMatrix(m, n) && !marked[n] && m[n] == value) {
+                marked[n] = true;
+                stack.push_back(n);
+            }
         }
     }
 }
@@ -930,54 +1966,110 @@ std::vector<Point> get_group(const Matrix<int>& m, Point p, int value) {
     return result;
 }
 
-void get_island_impl(const Matrix<int>& m, Point p,
-               Matrix<bool>& marked,
-               Point& min, Point& max,
-               std::vector<Point>& result) {
-    marked[p] = true;
-    min.x = std::min(min.x, p.x);
-    min.y = std::min(min.y, p.y);
-    max.x = std::max(max.x, p.x);
-    max.y = std::max(max.y, p.y);
-    result.push_back(p);
-    for (auto n : getAllNeigbors(p)) {
-        if(isInsideMatrix(m, n) && !marked[n] && m[n] != 0) {
-            get_island_impl(m, n, marked, min, max, result);
+struct Component {
+    Point first; // The first cell in row-major order.
+    Point min, max;
+    std::size_t size;
+};
+
+struct Components {
+    static constexpr std::uint32_t none = -1;
+    // The index of the component of each cell, none if it is in none.
+    Matrix<std::uint32_t> labels;
+    // In the order of their first cells.
+    std::vector<Component> components;
+};
+
+constexpr std::uint32_t Components::none;
+
+// Finds the connected components of the cells for which inside is true in
+// two passes over the board. The first one joins every cell with its left
+// and upper neighbors in a union-find forest whose roots are the first cells
+// of the components. The second one numbers the roots and gives every other
+// cell the number of its parent, which comes before it.
+template<typename Inside>
+Components label_components(const Matrix<int>& m, Inside inside) {
+    const std::size_t width = m.width();
+    Components result;
+    result.labels.reset(m.width(), m.height(), Components::none);
+    std::uint32_t* parent = &result.labels[0];
+    auto find = [parent](std::uint32_t i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    };
+    auto join = [&](std::uint32_t i, std::uint32_t j) {
+        std::uint32_t ri = find(i), rj = find(j);
+        if (ri < rj) {
+            parent[rj] = ri;
+        } else {
+            parent[ri] = rj;
+        }
+    };
+    for (std::uint32_t i = 0; i < m.size(); ++i) {
+        if (!inside(m[i])) {
+            continue;
+        }
+        parent[i] = i;
+        if (i % width > 0 && parent[i - 1] != Components::none) {
+            join(i, i - 1);
+        }
+        if (i >= width && parent[i - width] != Components::none) {
+            join(i, i - width);
         }
     }
-}
-// Returns a group, the groups first two elements are neigbors.
-std::vector<Point> get_island(const Matrix<int>& m, Point p,
-                             Matrix<bool>& marked,
-                             Point& min, Point& max
-                             ) {
-    // Matrix<bool> marked{m.width(), m.height()};
-    std::vector<Point> result;
-    get_island_impl(m, p, marked, min, max, result);
+
+    for (std::uint32_t i = 0; i < m.size(); ++i) {
+        if (parent[i] == Components::none) {
+            continue;
+        }
+        Point p(i % width, i / width);
+        if (parent[i] == i) {
+            parent[i] = result.components.size();
+            result.components.push_back({p, p, p, 0});
+        } else {
+            parent[i] = parent[parent[i]];
+        }
+        Component& component = result.components[parent[i]];
+        component.min.x = std::min(component.min.x, p.x);
+        component.max.x = std::max(component.max.x, p.x);
+        component.max.y = p.y;
+        ++component.size;
+    }
     return result;
 }
 
+// An island cut out of the board with a border of 0s, so that every cell
+// of the island has the same neighbors as on the whole board. origin is the
+// position of the top left corner of m on the board.
 struct IslandInfo {
     Matrix<int> m;
+    Point origin;
     size_t size;
 };
 
 std::vector<IslandInfo> gather_islands(const Matrix<int>& m) {
     std::vector<IslandInfo> result;
-    Matrix<bool> inIsland(m.width(), m.height(), false);
-    for (int i = 0; i < m.height(); ++i) {
-        for (int j = 0; j < m.width(); ++j) {
-            Point p{j, i};
-            if (m[p] !=0 && !inIsland[p]) {
-                Point min, max;
-                auto island = get_island(m, p, inIsland, min, max);
-                Matrix<int> islandMatrix{m.width(), m.height(), 0};
-                for (auto p : island) {
-                    islandMatrix[p] = m[p];
+    auto islands = label_components(m, [](int v) { return v != 0; });
+    for (std::uint32_t label = 0; label < islands.components.size();
+            ++label) {
+        const Component& island = islands.components[label];
+        Point origin{std::max(island.min.x - 1, 0),
+                     std::max(island.min.y - 1, 0)};
+        Point end{std::min<int>(island.max.x + 2, m.width()),
+                  std::min<int>(island.max.y + 2, m.height())};
+        Matrix<int> islandMatrix(end.x - origin.x, end.y - origin.y, 0);
+        for (int y = island.min.y; y <= island.max.y; ++y) {
+            for (int x = island.min.x; x <= island.max.x; ++x) {
+                Point p{x, y};
+                if (islands.labels[p] == label) {
+                    islandMatrix[p - origin] = m[p];
                 }
-                result.push_back({std::move(islandMatrix), island.size()});
             }
         }
+        result.push_back({std::move(islandMatrix), origin, island.size});
     }
     return result;
 }
@@ -1004,28 +2096,127 @@ std::vector<Point> to_vector(const std::vector<RankedPoints>& ps) {
 
 std::vector<RankedPoints> gather_groups(const Matrix<int>& m) {
     std::vector<RankedPoints> result;
-    Matrix<bool> inGroup(m.width(), m.height(), false);
-    for (int i = 0; i < m.height(); ++i) {
-        for (int j = 0; j < m.width(); ++j) {
-            Point p{j, i};
-            if (m[p] == 1 && !inGroup[p]) {
-                auto gr = get_group(m, p, 1, inGroup);
-                if (gr.size() >= 2) {
-                    result.emplace_back(gr[0], gr[1], gr.size()); //Add the nbor
-                } else {
-                    result.emplace_back(gr[0], gr.size());
-                }
-            }
+    auto groups = label_components(m, [](int v) { return v == 1; });
+    for (const auto& group : groups.components) {
+        Point p = group.first;
+        if (group.size >= 2) {
+            // The cells above and to the left of the first cell are not in
+            // the group, so the neighbor get_group() would put second is
+            // below or to the right.
+            Point below = p + p01;
+            Point nbor = isInsideMatrix(m, below) &&
+                    groups.labels[below] == groups.labels[p] ? below : p + p10;
+            result.emplace_back(p, nbor, group.size); //Add the nbor
+        } else {
+            result.emplace_back(p, group.size);
         }
     }
     return result;
 }
 
-std::vector<Point> solve(Matrix<int> m, const Matrix<int> diag = Matrix<int>{}) {
-    if (diag.size()) std::cout << "DIAG:\n" << diag;
+// The number of threads solve_islands() uses, 0 for one per core.
+unsigned islandThreads = 0;
+
+// The islands have no common cells, so they are solved in parallel, the
+// hardest (biggest, then most groups of 1s) first. The paths are returned in
+// the order of the islands, whichever finishes first. The path of an island
+// that could not be solved is only the end of a build order of it: the cells
+// propagate_forced() removed before the search, which can be none.
+SolveStatus solve_islands(const std::vector<IslandInfo>& islands,
+                          Deadline& deadline,
+                          std::vector<std::vector<Point>>& paths,
+                          SolveStats& stats) {
+    std::vector<std::vector<Point>> starts;
+    std::vector<SolveStats> islandStats(islands.size());
+    std::vector<SolveStatus> statuses(islands.size());
+    paths.assign(islands.size(), {});
+    std::vector<std::size_t> numGroups, order;
+    for (const auto& island : islands) {
+        //std::cerr << "Island:\n" << island.m;
+        if (deadline.expired()) {
+            return SolveStatus::timedOut;
+        }
+        auto groups = gather_groups(island.m);
+        std::sort(groups.begin(), groups.end(),
+                  [](const auto& l, const auto& r) { return l.rank < r.rank; });
+        numGroups.push_back(groups.size());
+        starts.push_back(to_vector(groups));
+        order.push_back(order.size());
+    }
+    std::stable_sort(order.begin(), order.end(),
+            [&](std::size_t l, std::size_t r) {
+                return std::make_pair(islands[l].size, numGroups[l]) >
+                        std::make_pair(islands[r].size, numGroups[r]);
+            });
+
+    std::atomic<std::size_t> next{0};
+    auto solveNext = [&]() {
+        for (std::size_t k; (k = next++) < order.size(); ) {
+            std::size_t i = order[k];
+            if (deadline.expired()) {
+                statuses[i] = SolveStatus::timedOut;
+                continue;
+            }
+            if (solve_exp_flood_first(starts[i], islands[i].m,
+                    islands[i].size, paths[i], deadline, islandStats[i])) {
+                statuses[i] = SolveStatus::solved;
+            } else if (deadline.expired()) {
+                statuses[i] = SolveStatus::timedOut;
+            } else {
+                statuses[i] = SolveStatus::failed;
+            }
+            for (auto& p : paths[i]) {
+                p += islands[i].origin;
+            }
+        }
+    };
+    std::size_t numThreads = islandThreads != 0 ? islandThreads
+            : std::max(std::thread::hardware_concurrency(), 1u);
+    numThreads = std::min(numThreads, order.size());
+    std::vector<std::thread> threads;
+    auto joinThreads = [&threads]() {
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    };
+    try {
+        for (std::size_t i = 1; i < numThreads; ++i) {
+            threads.emplace_back(solveNext);
+        }
+        solveNext();
+    } catch (...) {
+        // The islands are on the stack of this function, so the threads
+        // that started must finish before it returns. They need not start
+        // new islands.
+        next = order.size();
+        joinThreads();
+        throw;
+    }
+    joinThreads();
+    for (const auto& s : islandStats) {
+        stats += s;
+    }
+    // failed is the worst, then timedOut.
+    return statuses.empty() ? SolveStatus::solved
+            : *std::max_element(statuses.begin(), statuses.end());
+}
 
+struct SolveResult {
+    SolveStatus status;
+    // A build order. If the status is not solved, only the end of one: the
+    // cells that were not removed before the deadline or the failed search
+    // are missing, and they have to be built before it, in any order.
     std::vector<Point> path;
-    std::vector<Point> result;
+    SolveStats stats;
+};
+
+SolveResult solve(Matrix<int> m, Clock::time_point deadline,
+                  const Matrix<int>& diag = Matrix<int>{}) {
+    if (diag.size()) std::cout << "DIAG:\n" << diag;
+
+    SolveResult result{SolveStatus::solved, {}, {}};
+    std::vector<Point>& path = result.path;
+    Deadline solveDeadline{deadline};
 
     auto flood_ones_from_edges = [&]() {
         std::vector<Point> st;
@@ -1050,15 +2241,28 @@ std::vector<Point> solve(Matrix<int> m, const Matrix<int> diag = Matrix<int>{})
                 if (m[pN] == 1) st.push_back(pN);
             }
         }
-        flood(st, m, path);
+        if (!flood(st, m, path, nullptr, &solveDeadline) &&
+                !solveDeadline.expired()) {
+            ++result.stats.floodErrors;
+        }
     };
     flood_ones_from_edges();
 
+    InsideOnes insideOnes{m, &solveDeadline};
     while (m.size() != path.size()) {
+        // There can be many floods on a big board, and a path that stops
+        // early is still the end of a build order.
+        if (solveDeadline.expired()) {
+            break;
+        }
 
-        auto st = get_1s_inside(m);
+        auto st = insideOnes.get();
         // check_if_really_1(diag, st);
-        assert(st);
+        if (!st) {
+            ++result.stats.get1sErrors;
+            assert(false);
+            break;
+        }
 
         if (st->size() == 0) {
             //std::cerr << "FLOOD STOPPED:\n";
@@ -1066,22 +2270,26 @@ std::vector<Point> solve(Matrix<int> m, const Matrix<int> diag = Matrix<int>{})
             break;
         }
 
-        flood(*st, m, path);
+        std::size_t from = path.size();
+        if (!flood(*st, m, path, nullptr, &solveDeadline) &&
+                !solveDeadline.expired()) {
+            ++result.stats.floodErrors;
+        }
+        insideOnes.removed(path, from);
     }
 
-    if (m.size() != path.size()) {
+    if (m.size() != path.size() && solveDeadline.expired()) {
+        result.status = SolveStatus::timedOut;
+    } else if (m.size() != path.size()) {
 
         auto islands = gather_islands(m);
+        std::vector<std::vector<Point>> island_paths;
+        result.status = solve_islands(islands, solveDeadline, island_paths,
+                                      result.stats);
 
-        for (const auto& island : islands) {
-            //std::cerr << "Island:\n" << island.m;
-            auto groups = gather_groups(island.m);
-            std::sort(groups.begin(), groups.end(),
-                      [](const auto& l, const auto& r) { return l.rank < r.rank; });
-            auto st = to_vector(groups);
-            std::vector<Point> island_path;
-            auto res = solve_exp_flood_first(st, island.m, island.size, island_path);
-            path = concat(path, island_path);
+        for (const auto& island_path : island_paths) {
+            path.insert(path.end(), island_path.begin(),
+                        island_path.end());
             //std::cerr << "solution:\n" << island_path;
         }
 
@@ -1091,22 +2299,266 @@ std::vector<Point> solve(Matrix<int> m, const Matrix<int> diag = Matrix<int>{})
         //std::cerr << "solve returns: " << res << "\n";
     }
 
-    std::cerr << "False paths: " << numFalsePaths << "\n";
-    std::cerr << "Flood errors: " << floodErrors << "\n";
-    std::cerr << "Flooood errors: " << get1sErrors << "\n";
     std::reverse(path.begin(), path.end());
-    return path;
+    return result;
 }
 
-void CalculateBuildOrder(const std::vector<std::vector<int>>& buildings, std::vector<std::pair<size_t, size_t>>& solution) {
+std::vector<Point> solve(Matrix<int> m, const Matrix<int>& diag = Matrix<int>{}) {
+    return solve(std::move(m), Clock::time_point::max(), diag).path;
+}
+
+Matrix<int> toBoard(const std::vector<std::vector<int>>& buildings) {
     Matrix<int> m(buildings.at(0).size(), buildings.size());
-    for (int i = 0; i < buildings.size(); ++i){
-        for (int j = 0; j < buildings[i].size(); ++j) {
-            m[{j,i}] = buildings[i][j];
-        }
+    for (std::size_t i = 0; i < buildings.size(); ++i){
+        const auto& row = buildings[i];
+        std::copy(row.begin(), row.begin() + std::min(row.size(), m.width()),
+                  m.begin() + i * m.width());
     }
-    auto result = solve(m);
-    for (const auto& e : result) {
+    return m;
+}
+
+Clock::time_point deadlineAfter(Clock::duration budget) {
+    auto now = Clock::now();
+    return budget >= Clock::time_point::max() - now ?
+            Clock::time_point::max() : now + budget;
+}
+
+// Appends the order to solution, so with enough reserved it does not
+// allocate.
+SolveStatus calculateBuildOrder(Matrix<int> m, Clock::time_point deadline,
+                                std::vector<std::pair<size_t, size_t>>& solution,
+                                SolveStats* stats) {
+    auto result = solve(std::move(m), deadline);
+    for (const auto& e : result.path) {
         solution.emplace_back(e.y, e.x);
     }
+    if (stats) {
+        *stats = result.stats;
+    }
+    return result.status;
+}
+
+void CalculateBuildOrder(const std::vector<std::vector<int>>& buildings, std::vector<std::pair<size_t, size_t>>& solution) {
+    calculateBuildOrder(toBoard(buildings), Clock::time_point::max(),
+                        solution, nullptr);
+}
+
+// Gives up searching after budget. Unless the result is solved, solution is
+// only the end of a build order, see SolveResult.
+SolveStatus CalculateBuildOrder(const std::vector<std::vector<int>>& buildings,
+                                std::vector<std::pair<size_t, size_t>>& solution,
+                                Clock::duration budget,
+                                SolveStats* stats = nullptr) {
+    auto deadline = deadlineAfter(budget);
+    return calculateBuildOrder(toBoard(buildings), deadline, solution, stats);
+}
+
+// The board is height rows of width cells, the rows start stride cells
+// apart. The cells are copied once, because the solver changes its board.
+SolveStatus CalculateBuildOrder(const int* cells, std::size_t width,
+                                std::size_t height, std::size_t stride,
+                                std::vector<std::pair<size_t, size_t>>& solution,
+                                Clock::duration budget = Clock::duration::max(),
+                                SolveStats* stats = nullptr) {
+    auto deadline = deadlineAfter(budget);
+    Matrix<int> m(width, height);
+    for (std::size_t y = 0; y < height; ++y) {
+        std::copy(cells + y * stride, cells + y * stride + width,
+                  m.begin() + y * width);
+    }
+    return calculateBuildOrder(std::move(m), deadline, solution, stats);
+}
+
+// The board is the rows of width cells in cells, which the solver uses
+// without copying. Throws std::invalid_argument if cells is not whole rows.
+SolveStatus CalculateBuildOrder(std::vector<int>&& cells, std::size_t width,
+                                std::vector<std::pair<size_t, size_t>>& solution,
+                                Clock::duration budget = Clock::duration::max(),
+                                SolveStats* stats = nullptr) {
+    if (width == 0 ? !cells.empty() : cells.size() % width != 0) {
+        throw std::invalid_argument{"The cells are not rows of " +
+                                    std::to_string(width) + "."};
+    }
+    auto deadline = deadlineAfter(budget);
+    std::size_t height = width == 0 ? 0 : cells.size() / width;
+    return calculateBuildOrder(Matrix<int>(width, height, std::move(cells)),
+                               deadline, solution, stats);
+}
+
+// Parses a board from text that comes in chunks: a row on each line, one
+// digit for each cell, optionally separated by spaces. The board ends at the
+// first empty line or at the end of the text. The cells go straight to the
+// vector the solver's board is made of.
+class BoardReader {
+public:
+    void feed(const char* begin, const char* end) {
+        for (; begin != end && !done_ && error_.empty(); ++begin) {
+            char c = *begin;
+            if (c >= '0' && c <= '9') {
+                cells_.push_back(c - '0');
+                ++rowSize_;
+            } else if (c == '\n') {
+                if (rowSize_ != 0) {
+                    endRow();
+                } else if (height_ != 0) {
+                    done_ = true;
+                }
+            } else if (c != ' ' && c != '\t' && c != '\r') {
+                error_ = std::string{"Unexpected character in board: "} + c;
+            }
+        }
+    }
+
+    void reserve(std::size_t numCells) {
+        cells_.reserve(numCells);
+    }
+
+    // Throws std::runtime_error if the text is not a board.
+    Matrix<int> finish() {
+        if (rowSize_ != 0) {
+            endRow();
+        }
+        if (!error_.empty()) {
+            throw std::runtime_error{error_};
+        }
+        return Matrix<int>(width_, height_, std::move(cells_));
+    }
+
+private:
+    void endRow() {
+        if (height_ == 0) {
+            width_ = rowSize_;
+        } else if (rowSize_ != width_ && error_.empty()) {
+            error_ = "Row " + std::to_string(height_) + " has " +
+                    std::to_string(rowSize_) + " cells instead of " +
+                    std::to_string(width_);
+        }
+        ++height_;
+        rowSize_ = 0;
+    }
+
+    std::vector<int> cells_;
+    std::size_t width_ = 0, height_ = 0, rowSize_ = 0;
+    bool done_ = false;
+    std::string error_;
+};
+
+// Reads a board from the position of fd to its end, and leaves fd at the
+// end. Regular files are mapped. From pipes and sockets a thread reads the
+// next chunk while the previous one is parsed.
+Matrix<int> readBoard(int fd) {
+    BoardReader reader;
+    struct stat status;
+    off_t position = lseek(fd, 0, SEEK_CUR);
+    if (position >= 0 && fstat(fd, &status) == 0 &&
+            S_ISREG(status.st_mode) && status.st_size > position) {
+        // Mappings start at a page boundary.
+        off_t offset = position - position % sysconf(_SC_PAGESIZE);
+        std::size_t mappedSize = status.st_size - offset;
+        void* data = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd,
+                          offset);
+        if (data != MAP_FAILED) {
+            madvise(data, mappedSize, MADV_SEQUENTIAL);
+            const char* begin = static_cast<const char*>(data) +
+                    (position - offset);
+            const char* end = static_cast<const char*>(data) + mappedSize;
+            try {
+                // Assume that every line is like the first one.
+                auto lineEnd = static_cast<const char*>(
+                        std::memchr(begin, '\n', end - begin));
+                std::size_t lineSize = lineEnd ? lineEnd - begin + 1
+                                               : end - begin;
+                reader.reserve(std::count_if(begin, begin + lineSize,
+                        [](char c) { return c >= '0' && c <= '9'; }) *
+                        ((end - begin) / lineSize + 1));
+                reader.feed(begin, end);
+            } catch (...) {
+                munmap(data, mappedSize);
+                throw;
+            }
+            munmap(data, mappedSize);
+            lseek(fd, status.st_size, SEEK_SET);
+            return reader.finish();
+        }
+    }
+
+    constexpr std::size_t chunkSize = 1 << 20;
+    std::vector<char> buffers[2] = {std::vector<char>(chunkSize),
+                                    std::vector<char>(chunkSize)};
+    ssize_t sizes[2] = {0, 0};
+    bool full[2] = {false, false};
+    // The parsing failed, the thread must not read more.
+    bool stopped = false;
+    int readError = 0;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::thread readThread{[&]() {
+        for (int k = 0; ; k ^= 1) {
+            {
+                std::unique_lock<std::mutex> lock{mutex};
+                changed.wait(lock, [&]() { return !full[k] || stopped; });
+                if (stopped) {
+                    return;
+                }
+            }
+            ssize_t size;
+            do {
+                size = read(fd, buffers[k].data(), chunkSize);
+            } while (size < 0 && errno == EINTR);
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                readError = errno;
+                sizes[k] = size;
+                full[k] = true;
+            }
+            changed.notify_all();
+            if (size <= 0) {
+                return;
+            }
+        }
+    }};
+    ssize_t size = 0;
+    try {
+        for (int k = 0; ; k ^= 1) {
+            {
+                std::unique_lock<std::mutex> lock{mutex};
+                changed.wait(lock, [&]() { return full[k]; });
+                size = sizes[k];
+            }
+            if (size <= 0) {
+                break;
+            }
+            reader.feed(buffers[k].data(), buffers[k].data() + size);
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                full[k] = false;
+            }
+            changed.notify_all();
+        }
+    } catch (...) {
+        // The thread uses the buffers, and destroying it while it runs
+        // terminates the program. A read in progress is waited for.
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            stopped = true;
+        }
+        changed.notify_all();
+        readThread.join();
+        throw;
+    }
+    readThread.join();
+    if (size < 0) {
+        throw std::runtime_error{std::string{"Cannot read board: "} +
+                                 std::strerror(readError)};
+    }
+    return reader.finish();
+}
+
+// budget includes reading the board from fd.
+SolveStatus CalculateBuildOrder(int fd,
+                                std::vector<std::pair<size_t, size_t>>& solution,
+                                Clock::duration budget = Clock::duration::max(),
+                                SolveStats* stats = nullptr) {
+    auto deadline = deadlineAfter(budget);
+    return calculateBuildOrder(readBoard(fd), deadline, solution, stats);
 }
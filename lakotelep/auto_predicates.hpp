@@ -7,7 +7,7 @@ bool isEdgePoint(const Matrix<int>& mx, const Point& point) {
 }
 
 bool hasZeroNeighbour(const Matrix<int>& mx,
-        const std::vector<Point>& neighbours) {
+        const NeighborPoints& neighbours) {
     for (const auto& n : neighbours) {
         if (mx[n] == 0) {
             return true;
@@ -19,7 +19,7 @@ bool hasZeroNeighbour(const Matrix<int>& mx,
 // This also checks whether the point is surely needed to make
 // the edge two, three or four a one.
 bool hasEdgeNeighbourAtLeastTwo(const Matrix<int>& mx,
-        const std::vector<Point>& neighbours) {
+        const NeighborPoints& neighbours) {
     for (const auto& in : neighbours) {
         if (mx[in] >= 2 && isEdgePoint(mx, in)) {
             auto ns = getNeigbors(mx, in);
@@ -38,7 +38,7 @@ bool hasEdgeNeighbourAtLeastTwo(const Matrix<int>& mx,
 }
 
 bool hasEdgeNeighbourOne(const Matrix<int>& mx,
-        const std::vector<Point>& neighbours) {
+        const NeighborPoints& neighbours) {
     for (const auto& n : neighbours) {
         if (mx[n] == 1 && isEdgePoint(mx, n)) {
             return true;
@@ -48,7 +48,7 @@ bool hasEdgeNeighbourOne(const Matrix<int>& mx,
 }
 
 bool hasNeighbourFive(const Matrix<int>& mx,
-        const std::vector<Point>& neighbours) {
+        const NeighborPoints& neighbours) {
     for (const auto& n : neighbours) {
         if (mx[n] == 5 && !isEdgePoint(mx, n)) {
             return true;
@@ -58,7 +58,7 @@ bool hasNeighbourFive(const Matrix<int>& mx,
 }
 
 bool hasNeighbourOne(const Matrix<int>& mx,
-        const std::vector<Point>& neighbours) {
+        const NeighborPoints& neighbours) {
     for (const auto& n : neighbours) {
         if (mx[n] == 1 && !isEdgePoint(mx, n)) {
             return true;
@@ -68,7 +68,7 @@ bool hasNeighbourOne(const Matrix<int>& mx,
 }
 
 bool hasOneNeighbourZeroNeighbour(const Matrix<int>& mx,
-        const std::vector<Point>& neighbours) {
+        const NeighborPoints& neighbours) {
     for (const auto& in : neighbours) {
         if (mx[in] != 1) {
             continue;
@@ -83,8 +83,8 @@ bool hasOneNeighbourZeroNeighbour(const Matrix<int>& mx,
     return false;
 }
 
-std::vector<Point> findNeighboursOne(const Matrix<int>& mx,
-        std::vector<Point> neighbours) {
+NeighborPoints findNeighboursOne(const Matrix<int>& mx,
+        NeighborPoints neighbours) {
     assert(hasNeighbourOne(mx, neighbours));
     neighbours.erase(std::remove_if(neighbours.begin(), neighbours.end(),
                     [&mx](const Point& n) {
@@ -94,7 +94,7 @@ std::vector<Point> findNeighboursOne(const Matrix<int>& mx,
 }
 
 bool hasNeighbourPlacedBefore(const Matrix<int>& mx,
-        const std::vector<Point>& neighbours) {
+        const NeighborPoints& neighbours) {
     for (const auto& in : neighbours) {
         auto ns = getNeigbors(mx, in);
         int nonZeroNeighbours = 0;
@@ -111,7 +111,7 @@ bool hasNeighbourPlacedBefore(const Matrix<int>& mx,
 }
 
 bool hasTooLowValueNeighbour(const Matrix<int>& mx,
-        const std::vector<Point>& neighbours, const Point& p) {
+        const NeighborPoints& neighbours, const Point& p) {
     for (const auto& in : neighbours) {
         if (mx[in] == 1) {
             continue;
@@ -139,6 +139,6 @@ bool hasTooLowValueNeighbour(const Matrix<int>& mx,
 // 0 0 3 3
 // 1,1 depends on the 1 on 3,2
 bool hasNeighbourDependingOnThis(const Matrix<int>& mx,
-        const std::vector<Point>& neighbours) {
+        const NeighborPoints& neighbours) {
     return false;
 }
@@ -1,10 +1,18 @@
 #include "all.cpp"
 
-int main(int /*argc*/, const char* argv[]) {
-    auto m = pair::generate(atoi(argv[1]), atoi(argv[2]));
+// Usage: lakotelep <width> <height> [<seed>]
+int main(int argc, const char* argv[]) {
+    auto m = argc > 3 ?
+            pair::generate(atoi(argv[1]), atoi(argv[2]), atoi(argv[3])) :
+            pair::generate(atoi(argv[1]), atoi(argv[2]));
     std::cerr << "Unmodified matrix:\n" << m.first <<
             "\nProblem:\n" << m.second << "\n";
-    auto solution = solve(m.second, m.first);
+    auto result = solve(m.second, Clock::time_point::max(), m.first);
+    const auto& solution = result.path;
+    std::cerr << "False paths: " << result.stats.falsePaths << "\n";
+    std::cerr << "Flood errors: " << result.stats.floodErrors << "\n";
+    std::cerr << "Flooood errors: " << result.stats.get1sErrors << "\n";
+    std::cerr << "Decided cells: " << result.stats.decidedCells << "\n";
     if (check(solution, m.second)) {
         std::cerr << "OK\n";
     } else {
@@ -0,0 +1,108 @@
+#include "all.cpp"
+
+#include <sys/resource.h>
+
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+
+// Usage: lakotelep_stress <max size> <seeds> [<budget ms>] [<failures file>]
+//
+// Solves <seeds> square boards of every size up to <max size> with the
+// deadline of CalculateBuildOrder and prints a line for each size. The boards
+// are pair::generate(size, size, seed), so a line "<size> <size> <seed>" of
+// the failures file is the arguments of lakotelep_main to solve it again.
+
+namespace {
+
+const int sizes[] = {10, 20, 40, 100, 330, 1000, 3300};
+
+double percentile(std::vector<double> values, double p) {
+    std::sort(values.begin(), values.end());
+    std::size_t rank = std::ceil(p * values.size());
+    return values[std::max<std::size_t>(rank, 1) - 1];
+}
+
+long peakRssKb() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+const char* statusName(SolveStatus status) {
+    switch (status) {
+    case SolveStatus::solved: return "solved";
+    case SolveStatus::timedOut: return "timeout";
+    case SolveStatus::failed: return "failed";
+    }
+    return "";
+}
+
+} // unnamed namespace
+
+int main(int argc, const char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] <<
+                " <max size> <seeds> [<budget ms>] [<failures file>]\n";
+        return 2;
+    }
+    int maxSize = atoi(argv[1]);
+    unsigned seeds = std::max(atoi(argv[2]), 1);
+    auto budget = std::chrono::milliseconds(argc > 3 ? atoi(argv[3]) : 1000);
+    std::ofstream failures;
+    if (argc > 4) {
+        failures.open(argv[4], std::ios::app);
+    }
+
+    std::cout << std::setw(6) << "size" << std::setw(8) << "solved" <<
+            std::setw(8) << "timeout" << std::setw(8) << "failed" <<
+            std::setw(6) << "bad" << std::setw(10) << "p50 ms" <<
+            std::setw(10) << "p99 ms" << std::setw(12) << "rss MB" <<
+            std::setw(12) << "false" << std::setw(8) << "flood" <<
+            std::setw(10) << "decided" << "\n";
+    int numFailures = 0;
+    for (int size : sizes) {
+        if (size > maxSize) {
+            break;
+        }
+        std::vector<double> times;
+        int counts[3] = {0, 0, 0};
+        int bad = 0;
+        SolveStats total;
+        for (unsigned seed = 0; seed < seeds; ++seed) {
+            auto board = pair::generate(size, size, seed).second;
+            auto start = Clock::now();
+            auto result = solve(board, deadlineAfter(budget));
+            times.push_back(std::chrono::duration<double, std::milli>(
+                    Clock::now() - start).count());
+            total += result.stats;
+            ++counts[static_cast<int>(result.status)];
+
+            const char* failure = nullptr;
+            if (result.status != SolveStatus::solved) {
+                failure = statusName(result.status);
+            } else if (!check(result.path, board)) {
+                ++bad;
+                failure = "bad";
+            }
+            if (failure) {
+                ++numFailures;
+                if (failures.is_open()) {
+                    failures << size << " " << size << " " << seed << " " <<
+                            failure << std::endl;
+                }
+            }
+        }
+        std::cout << std::setw(6) << size <<
+                std::setw(8) << counts[0] << std::setw(8) << counts[1] <<
+                std::setw(8) << counts[2] << std::setw(6) << bad <<
+                std::fixed << std::setprecision(1) <<
+                std::setw(10) << percentile(times, 0.5) <<
+                std::setw(10) << percentile(times, 0.99) <<
+                std::setw(12) << peakRssKb() / 1024.0 <<
+                std::setw(12) << total.falsePaths <<
+                std::setw(8) << total.floodErrors <<
+                std::setw(10) << total.decidedCells << std::endl;
+    }
+    return numFailures == 0 ? 0 : 1;
+}
@@ -352,3 +352,327 @@ TEST(Big, seq) {
         }
     }
 }
+
+TEST(solve_islands, threads) {
+    for (unsigned seed = 0; seed < 20; ++seed) {
+        auto m = pair::generate(12, 12, seed).second;
+        islandThreads = 1;
+        auto expected = solve(m);
+        islandThreads = 4;
+        auto ps = solve(m);
+        islandThreads = 0;
+        EXPECT_EQ(expected, ps);
+        EXPECT_TRUE(check(ps, m));
+    }
+}
+
+TEST(check, same_as_build) {
+    std::mt19937 g(5);
+    for (int i = 0; i < 200; ++i) {
+        auto m = pair::generate(g() % 8 + 1, g() % 8 + 1).second;
+        std::vector<Point> ps;
+        for (int j = g() % (m.size() + 3); j > 0; --j) {
+            ps.emplace_back(g() % m.width(), g() % m.height());
+        }
+        auto built = build(m.width(), m.height(), ps);
+        EXPECT_TRUE(check(ps, built));
+        EXPECT_EQ(build(m.width(), m.height(), ps) == m, check(ps, m));
+        auto solution = solve(m);
+        EXPECT_TRUE(check(solution, m));
+        if (solution.size() >= 2) {
+            std::swap(solution.front(), solution.back());
+            EXPECT_EQ(build(m.width(), m.height(), solution) == m,
+                      check(solution, m));
+        }
+    }
+}
+
+TEST(check, threads) {
+    std::vector<Point> ps;
+    for (int x = 0; x < 300; ++x) {
+        for (int y = 0; y < 500; ++y) {
+            ps.emplace_back(x, y);
+        }
+    }
+    std::shuffle(ps.begin(), ps.end(), std::mt19937{7});
+    auto m = build(300, 500, ps);
+    checkThreads = 3;
+    EXPECT_TRUE(check(ps, m));
+    m[{150, 499}] = m[{150, 499}] % 4 + 1;
+    EXPECT_FALSE(check(ps, m));
+    checkThreads = 0;
+}
+
+// Checks a solution that is only the end of a build order unless it is
+// solved: with the cells that are not in it built first, in any order, the
+// cells in it get their values.
+void checkSolutionEnd(const Matrix<int>& m,
+        const std::vector<std::pair<size_t, size_t>>& solution,
+        SolveStatus status) {
+    std::vector<Point> ps;
+    Matrix<bool> inSolution(m.width(), m.height(), false);
+    for (const auto& e : solution) {
+        ps.emplace_back(e.second, e.first);
+        inSolution[ps.back()] = true;
+    }
+    if (status == SolveStatus::solved) {
+        EXPECT_TRUE(check(ps, m));
+        return;
+    }
+    ASSERT_EQ(status, SolveStatus::timedOut);
+    std::vector<Point> all;
+    for (Point p : matrixRange(m)) {
+        if (!inSolution[p]) {
+            all.push_back(p);
+        }
+    }
+    all.insert(all.end(), ps.begin(), ps.end());
+    auto built = build(m.width(), m.height(), all);
+    for (Point p : ps) {
+        EXPECT_EQ(built[p], m[p]) << p;
+    }
+}
+
+std::vector<std::vector<int>> toBuildings(const Matrix<int>& m) {
+    std::vector<std::vector<int>> result(m.height(),
+            std::vector<int>(m.width()));
+    for (Point p : matrixRange(m)) {
+        result[p.y][p.x] = m[p];
+    }
+    return result;
+}
+
+TEST(CalculateBuildOrder, timeout) {
+    for (unsigned seed = 0; seed < 20; ++seed) {
+        auto m = pair::generate(15, 15, seed).second;
+        std::vector<std::pair<size_t, size_t>> solution;
+        SolveStats stats;
+        auto status = CalculateBuildOrder(toBuildings(m), solution,
+                Clock::duration::zero(), &stats);
+        EXPECT_EQ(stats.falsePaths, 0);
+        checkSolutionEnd(m, solution, status);
+    }
+}
+
+// With some time the islands are searched, and those that are not solved
+// yet leave the cells that were decided before the search in the solution.
+TEST(CalculateBuildOrder, timeoutInIslands) {
+    for (unsigned seed = 0; seed < 10; ++seed) {
+        auto m = pair::generate(60, 60, seed).second;
+        for (auto budget : {std::chrono::milliseconds(1),
+                            std::chrono::milliseconds(5),
+                            std::chrono::milliseconds(20)}) {
+            std::vector<std::pair<size_t, size_t>> solution;
+            auto status = CalculateBuildOrder(toBuildings(m), solution,
+                                              budget);
+            checkSolutionEnd(m, solution, status);
+        }
+    }
+}
+
+TEST(CalculateBuildOrder, flat) {
+    for (int i = 0; i < 20; ++i) {
+        auto m = pair::generate(9, 7).second;
+        std::vector<std::vector<int>> buildings(m.height());
+        std::vector<int> padded;
+        for (std::size_t y = 0; y < m.height(); ++y) {
+            for (std::size_t x = 0; x < m.width(); ++x) {
+                buildings[y].push_back(m[Point(x, y)]);
+                padded.push_back(m[Point(x, y)]);
+            }
+            padded.push_back(-1);
+        }
+        std::vector<std::pair<size_t, size_t>> expected;
+        CalculateBuildOrder(buildings, expected);
+
+        std::vector<std::pair<size_t, size_t>> solution;
+        solution.reserve(m.size());
+        EXPECT_EQ(CalculateBuildOrder(padded.data(), m.width(), m.height(),
+                                      m.width() + 1, solution),
+                  SolveStatus::solved);
+        EXPECT_EQ(expected, solution);
+
+        solution.clear();
+        std::vector<int> cells(m.begin(), m.end());
+        EXPECT_EQ(CalculateBuildOrder(std::move(cells), m.width(), solution),
+                  SolveStatus::solved);
+        EXPECT_EQ(expected, solution);
+    }
+}
+
+TEST(CalculateBuildOrder, badLength) {
+    std::vector<std::pair<size_t, size_t>> solution;
+    EXPECT_THROW(CalculateBuildOrder(std::vector<int>(7, 1), 3, solution),
+                 std::invalid_argument);
+    EXPECT_THROW(CalculateBuildOrder(std::vector<int>(2, 1), 0, solution),
+                 std::invalid_argument);
+    EXPECT_TRUE(solution.empty());
+}
+
+TEST(generate, seed) {
+    EXPECT_EQ(pair::generate(6, 5, 42), pair::generate(6, 5, 42));
+    EXPECT_EQ(generate(6, 5, 42), generate(6, 5, 42));
+    EXPECT_NE(pair::generate(6, 5, 42).second,
+              pair::generate(6, 5, 43).second);
+}
+
+TEST(dumpMatrix, unsigned) {
+    DumpOptions options;
+    options.colour = false;
+    std::ostringstream ss;
+    dumpMatrix(ss, Matrix<unsigned>{2, 2, 3u}, options);
+    EXPECT_EQ(" 3 3\n 3 3\n\n", ss.str());
+    ss.str("");
+    Matrix<std::size_t> sizes{2, 1, 7};
+    sizes[Point(1, 0)] = 123456;
+    dumpMatrix(ss, sizes, options);
+    EXPECT_EQ("      7 123456\n\n", ss.str());
+}
+
+struct Label {
+    char name;
+};
+
+TEST(dumpMatrix, notComparable) {
+    Matrix<Label> labels{4, 1, Label{'a'}};
+    labels[Point(3, 0)] = Label{'b'};
+    DumpOptions options;
+    options.colour = false;
+    options.maxWidth = 2;
+    std::ostringstream ss;
+    dumpMatrix(ss, labels, options,
+               [](const Label& label) { return std::string{label.name}; });
+    EXPECT_EQ("(2x1 blocks)\n a a\n\n", ss.str());
+}
+
+TEST(solve, propagation) {
+    int decided = 0;
+    for (unsigned seed = 0; seed < 20; ++seed) {
+        auto m = pair::generate(12, 12, seed).second;
+        auto result = solve(m, Clock::time_point::max());
+        ASSERT_EQ(result.status, SolveStatus::solved);
+        EXPECT_TRUE(check(result.path, m));
+        EXPECT_LE(result.stats.decidedCells, static_cast<int>(m.size()));
+        decided += result.stats.decidedCells;
+    }
+    EXPECT_GT(decided, 0);
+}
+
+TEST(solve, budget) {
+    auto m = pair::generate(1000, 1000, 1).second;
+    for (auto budget : {std::chrono::milliseconds(0),
+                        std::chrono::milliseconds(100)}) {
+        auto start = Clock::now();
+        auto result = solve(m, deadlineAfter(budget));
+        auto elapsed = Clock::now() - start;
+        EXPECT_EQ(result.status, SolveStatus::timedOut);
+        // Freeing what the search built is not bounded by the deadline.
+        EXPECT_LT(elapsed, budget + std::chrono::milliseconds(100));
+    }
+}
+
+std::string boardText(const Matrix<int>& m) {
+    std::string result;
+    for (std::size_t y = 0; y < m.height(); ++y) {
+        for (std::size_t x = 0; x < m.width(); ++x) {
+            result += ' ';
+            result += '0' + m[Point(x, y)];
+        }
+        result += '\n';
+    }
+    return result;
+}
+
+TEST(BoardReader, chunks) {
+    auto m = pair::generate(7, 5, 3).second;
+    std::string text = boardText(m) + "\n";
+    for (std::size_t split = 0; split <= text.size(); ++split) {
+        BoardReader reader;
+        reader.feed(text.data(), text.data() + split);
+        reader.feed(text.data() + split, text.data() + text.size());
+        EXPECT_EQ(m, reader.finish()) << split;
+    }
+
+    BoardReader reader;
+    std::string digits = "1234\n4321\n\n55";
+    reader.feed(digits.data(), digits.data() + digits.size());
+    auto board = reader.finish();
+    EXPECT_EQ(board.width(), 4);
+    EXPECT_EQ(board.height(), 2);
+    EXPECT_EQ(board[Point(0, 1)], 4);
+
+    BoardReader bad;
+    std::string ragged = "123\n12\n";
+    bad.feed(ragged.data(), ragged.data() + ragged.size());
+    EXPECT_THROW(bad.finish(), std::runtime_error);
+}
+
+TEST(readBoard, pipeAndFile) {
+    auto m = pair::generate(300, 200, 4).second;
+    std::string text = boardText(m);
+
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    std::thread writer{[&]() {
+        for (std::size_t written = 0; written < text.size(); ) {
+            written += write(fds[1], text.data() + written,
+                             std::min<std::size_t>(text.size() - written, 4096));
+        }
+        close(fds[1]);
+    }};
+    EXPECT_EQ(m, readBoard(fds[0]));
+    writer.join();
+    close(fds[0]);
+
+    char fileName[] = "/tmp/lakotelep_boardXXXXXX";
+    int fd = mkstemp(fileName);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(write(fd, text.data(), text.size()),
+              static_cast<ssize_t>(text.size()));
+    ASSERT_EQ(lseek(fd, 0, SEEK_SET), 0);
+    EXPECT_EQ(m, readBoard(fd));
+    EXPECT_EQ(lseek(fd, 0, SEEK_CUR), static_cast<off_t>(text.size()));
+    close(fd);
+    unlink(fileName);
+}
+
+// Both read from the position of the descriptor, which is not on a page
+// boundary here.
+TEST(readBoard, position) {
+    auto m = pair::generate(300, 200, 5).second;
+    std::string text = boardText(m);
+    std::string skipped(5000, '7');
+    skipped += '\n';
+
+    char fileName[] = "/tmp/lakotelep_boardXXXXXX";
+    int fd = mkstemp(fileName);
+    ASSERT_GE(fd, 0);
+    std::string contents = skipped + text;
+    ASSERT_EQ(write(fd, contents.data(), contents.size()),
+              static_cast<ssize_t>(contents.size()));
+    ASSERT_EQ(lseek(fd, skipped.size(), SEEK_SET),
+              static_cast<off_t>(skipped.size()));
+    EXPECT_EQ(m, readBoard(fd));
+    // At the end there is nothing left to read.
+    EXPECT_EQ(Matrix<int>{}, readBoard(fd));
+    close(fd);
+    unlink(fileName);
+
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    std::thread writer{[&]() {
+        for (std::size_t written = 0; written < contents.size(); ) {
+            written += write(fds[1], contents.data() + written,
+                             std::min<std::size_t>(contents.size() - written,
+                                                   4096));
+        }
+        close(fds[1]);
+    }};
+    std::vector<char> buffer(skipped.size());
+    for (std::size_t done = 0; done < buffer.size(); ) {
+        done += read(fds[0], buffer.data() + done, buffer.size() - done);
+    }
+    EXPECT_EQ(m, readBoard(fds[0]));
+    writer.join();
+    close(fds[0]);
+}
@@ -0,0 +1,249 @@
+#ifndef UTIL_BITMATRIX_HPP
+#define UTIL_BITMATRIX_HPP
+
+#include "Matrix.hpp"
+
+#include <algorithm>
+#include <assert.h>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+// Matrix of bools with one bit per cell. Every row starts with a new word, so
+// whole rows can be combined a word at a time. The bits after the end of a
+// row are always zero.
+class BitMatrix {
+public:
+    typedef std::uint64_t Word;
+    static constexpr std::size_t wordBits = 64;
+
+    class reference {
+    public:
+        operator bool() const { return (*word_ & mask_) != 0; }
+        reference& operator=(bool value) {
+            if (value) {
+                *word_ |= mask_;
+            } else {
+                *word_ &= ~mask_;
+            }
+            return *this;
+        }
+        reference& operator=(const reference& other) {
+            return *this = static_cast<bool>(other);
+        }
+    private:
+        friend class BitMatrix;
+        reference(Word* word, Word mask): word_(word), mask_(mask) {}
+
+        Word* word_;
+        Word mask_;
+    };
+    typedef bool valueType;
+    typedef bool const_reference;
+
+    BitMatrix(): width_(0), height_(0), wordsPerRow_(0) {}
+    BitMatrix(std::size_t width, std::size_t height, bool defValue = false):
+        width_(width), height_(height),
+        wordsPerRow_((width + wordBits - 1) / wordBits),
+        data_(wordsPerRow_ * height)
+    {
+        fill(defValue);
+    }
+
+    reference operator[](Point p) {
+        assert(isInsideMatrix(*this, p));
+        return reference{&data_[wordIndex(p)], mask(p)};
+    }
+    const_reference operator[](Point p) const {
+        assert(isInsideMatrix(*this, p));
+        return (data_[wordIndex(p)] & mask(p)) != 0;
+    }
+    std::size_t size() const { return width_ * height_; }
+    std::size_t width() const { return width_; }
+    std::size_t height() const { return height_; }
+    std::size_t wordsPerRow() const { return wordsPerRow_; }
+
+    void reset(std::size_t newWidth, std::size_t newHeight,
+            bool defValue = false)
+    {
+        width_ = newWidth;
+        height_ = newHeight;
+        wordsPerRow_ = (width_ + wordBits - 1) / wordBits;
+        data_.resize(wordsPerRow_ * height_);
+        fill(defValue);
+    }
+    void fill(bool value)
+    {
+        boost::fill(data_, value ? ~Word{0} : Word{0});
+        clearPadding();
+    }
+    void clear()
+    {
+        data_.clear();
+        width_ = 0;
+        height_ = 0;
+        wordsPerRow_ = 0;
+    }
+
+    Word* row(std::size_t y) { return &data_[y * wordsPerRow_]; }
+    const Word* row(std::size_t y) const { return &data_[y * wordsPerRow_]; }
+
+    BitMatrix& operator&=(const BitMatrix& other)
+    {
+        assert(data_.size() == other.data_.size());
+        for (std::size_t i = 0; i < data_.size(); ++i) {
+            data_[i] &= other.data_[i];
+        }
+        return *this;
+    }
+    BitMatrix& operator|=(const BitMatrix& other)
+    {
+        assert(data_.size() == other.data_.size());
+        for (std::size_t i = 0; i < data_.size(); ++i) {
+            data_[i] |= other.data_[i];
+        }
+        return *this;
+    }
+    BitMatrix& operator^=(const BitMatrix& other)
+    {
+        assert(data_.size() == other.data_.size());
+        for (std::size_t i = 0; i < data_.size(); ++i) {
+            data_[i] ^= other.data_[i];
+        }
+        return *this;
+    }
+    // Negates every cell.
+    void flip()
+    {
+        for (Word& word : data_) {
+            word = ~word;
+        }
+        clearPadding();
+    }
+
+    // Moves every cell n columns to the right (to the left if n is
+    // negative). The cells shifted in are false.
+    void shiftX(int n)
+    {
+        for (std::size_t y = 0; y < height_; ++y) {
+            if (n > 0) {
+                shiftRowRight(row(y), n);
+            } else if (n < 0) {
+                shiftRowLeft(row(y), -n);
+            }
+        }
+        clearPadding();
+    }
+    // Moves every cell n rows down (up if n is negative). The cells shifted
+    // in are false.
+    void shiftY(int n)
+    {
+        std::size_t rows = std::min<std::size_t>(std::abs(n), height_);
+        std::size_t shift = rows * wordsPerRow_;
+        if (n > 0) {
+            std::copy_backward(data_.begin(), data_.end() - shift,
+                    data_.end());
+            std::fill(data_.begin(), data_.begin() + shift, Word{0});
+        } else if (n < 0) {
+            std::copy(data_.begin() + shift, data_.end(), data_.begin());
+            std::fill(data_.end() - shift, data_.end(), Word{0});
+        }
+    }
+
+    // The number of true cells.
+    std::size_t count() const
+    {
+        std::size_t result = 0;
+        for (Word word : data_) {
+            result += __builtin_popcountll(word);
+        }
+        return result;
+    }
+    std::size_t countRow(std::size_t y) const
+    {
+        std::size_t result = 0;
+        for (const Word* word = row(y); word != row(y) + wordsPerRow_;
+                ++word) {
+            result += __builtin_popcountll(*word);
+        }
+        return result;
+    }
+
+    bool operator==(const BitMatrix& other) const
+    {
+        return width_ == other.width_ && data_ == other.data_;
+    }
+
+    const std::vector<Word>& words() const { return data_; }
+
+private:
+    std::size_t wordIndex(Point p) const {
+        return p.y * wordsPerRow_ + p.x / wordBits;
+    }
+    static Word mask(Point p) {
+        return Word{1} << (p.x % wordBits);
+    }
+
+    void clearPadding()
+    {
+        std::size_t usedBits = width_ % wordBits;
+        if (usedBits == 0) {
+            return;
+        }
+        Word lastWordMask = (Word{1} << usedBits) - 1;
+        for (std::size_t y = 0; y < height_; ++y) {
+            row(y)[wordsPerRow_ - 1] &= lastWordMask;
+        }
+    }
+
+    void shiftRowRight(Word* row, std::size_t n)
+    {
+        std::size_t wordShift = n / wordBits;
+        std::size_t bitShift = n % wordBits;
+        for (std::size_t i = wordsPerRow_; i-- != 0; ) {
+            Word value = 0;
+            if (i >= wordShift) {
+                value = row[i - wordShift] << bitShift;
+                if (bitShift != 0 && i >= wordShift + 1) {
+                    value |= row[i - wordShift - 1] >> (wordBits - bitShift);
+                }
+            }
+            row[i] = value;
+        }
+    }
+    void shiftRowLeft(Word* row, std::size_t n)
+    {
+        std::size_t wordShift = n / wordBits;
+        std::size_t bitShift = n % wordBits;
+        for (std::size_t i = 0; i < wordsPerRow_; ++i) {
+            Word value = 0;
+            if (i + wordShift < wordsPerRow_) {
+                value = row[i + wordShift] >> bitShift;
+                if (bitShift != 0 && i + wordShift + 1 < wordsPerRow_) {
+                    value |= row[i + wordShift + 1] << (wordBits - bitShift);
+                }
+            }
+            row[i] = value;
+        }
+    }
+
+    std::size_t width_, height_, wordsPerRow_;
+    std::vector<Word> data_;
+};
+
+inline bool operator!=(const BitMatrix& lhs, const BitMatrix& rhs) {
+    return !(lhs == rhs);
+}
+
+namespace std {
+template<>
+struct hash<BitMatrix> {
+    size_t operator()(const BitMatrix& matrix) const {
+        return hashBytes(matrix.words().data(),
+                matrix.words().size() * sizeof(BitMatrix::Word));
+    }
+};
+
+}
+
+#endif // UTIL_BITMATRIX_HPP
@@ -2,8 +2,12 @@
 #define UTIL_DUMPERFUNCTIONS_HPP
 
 #include "Matrix.hpp"
+
+#include <algorithm>
 #include <iostream>
 #include <string>
+#include <type_traits>
+#include <utility>
 
 struct ToString {
     template<typename T>
@@ -17,41 +21,203 @@ struct ToString {
     }
 };
 
-template<typename T, typename Converter = ToString>
-void dumpMatrix(std::ostream& file, const Matrix<T> table,
-        const std::string& title = "", int indent = 0,
-        const Converter& converter = Converter{}) {
-    std::string indentString(indent, ' ');
-    if (!title.empty()) {
-        file << indentString << title << std::endl;
+struct DumpOptions {
+    std::string title;
+    int indent = 0;
+    // Every 5th and 10th row and column are highlighted with ANSI colours.
+    bool colour = true;
+    // If the matrix is larger, every printed cell stands for a block of
+    // cells and shows the largest value of the block, or the first one if
+    // the cells have no operator<. 0 means no limit.
+    std::size_t maxWidth = 0;
+    std::size_t maxHeight = 0;
+};
+
+namespace detail {
+
+inline
+std::size_t dumpBlockSize(std::size_t size, std::size_t maxSize) {
+    return maxSize == 0 || size <= maxSize ?
+            1 : (size + maxSize - 1) / maxSize;
+}
+
+template<typename T, typename = void>
+struct IsLessThanComparable: std::false_type {};
+
+template<typename T>
+struct IsLessThanComparable<T, decltype(void(
+        std::declval<const T&>() < std::declval<const T&>()))>:
+        std::true_type {};
+
+template<typename T, typename Layout>
+T dumpBlockValue(const Matrix<T, Layout>& table, Point begin, Point blockSize,
+        std::true_type /*isLessThanComparable*/) {
+    Point end{std::min<int>(begin.x + blockSize.x, table.width()),
+            std::min<int>(begin.y + blockSize.y, table.height())};
+    T result = table[begin];
+    for (Point p : PointRange{begin, end}) {
+        if (result < table[p]) {
+            result = table[p];
+        }
+    }
+    return result;
+}
+
+// Cells that cannot be compared show the first cell of the block.
+template<typename T, typename Layout>
+T dumpBlockValue(const Matrix<T, Layout>& table, Point begin,
+        Point /*blockSize*/, std::false_type /*isLessThanComparable*/) {
+    return table[begin];
+}
+
+template<typename Converter, typename T>
+std::size_t convertedSize(const Converter& converter, const T& value) {
+    return converter(value).size();
+}
+
+template<typename Converter, typename T>
+char* appendConverted(char* out, std::size_t width,
+        const Converter& converter, const T& value) {
+    std::string text = converter(value);
+    std::size_t padding = width - std::min(width, text.size());
+    std::fill_n(out, padding, ' ');
+    return std::copy(text.begin(), text.end(), out + padding);
+}
+
+// Integers are formatted in place without a temporary string.
+template<typename T>
+using EnableIfFormattedInPlace = typename std::enable_if<
+        std::is_integral<T>::value && !std::is_same<T, char>::value &&
+        !std::is_same<T, bool>::value>::type;
+
+template<typename T, typename = EnableIfFormattedInPlace<T>>
+std::size_t convertedSize(const ToString& /*converter*/, T value) {
+    // Division rounds towards zero, so this counts the digits of negative
+    // numbers too. Comparing with -10 would not work for unsigned T.
+    std::size_t result = value < 0 ? 2 : 1;
+    for (value /= 10; value != 0; value /= 10) {
+        ++result;
     }
-    Matrix<std::string> txts(table.width(), table.height());
-    size_t maxlen = 0;
-    for (Point  p: matrixRange(table)) {
-        txts[p] = converter(table[p]);
-        maxlen = std::max(maxlen, txts[p].size());
+    return result;
+}
+
+template<typename T, typename = EnableIfFormattedInPlace<T>>
+char* appendConverted(char* out, std::size_t width,
+        const ToString& /*converter*/, T value) {
+    // The digits are written backwards from the end of the cell. The
+    // width is always enough, it is the longest cell plus one.
+    char* end = out + width;
+    char* begin = end;
+    bool negative = value < 0;
+    do {
+        int digit = static_cast<int>(value % 10);
+        *--begin = '0' + (negative ? -digit : digit);
+        value /= 10;
+    } while (value != 0);
+    if (negative) {
+        *--begin = '-';
+    }
+    while (begin != out) {
+        *--begin = ' ';
+    }
+    return end;
+}
+
+inline
+char* appendText(char* out, const std::string& text) {
+    return std::copy(text.begin(), text.end(), out);
+}
+
+} // namespace detail
+
+// Formats the whole matrix into a single string.
+template<typename T, typename Layout, typename Converter = ToString>
+std::string renderMatrix(const Matrix<T, Layout>& table,
+        const DumpOptions& options = DumpOptions{},
+        const Converter& converter = Converter{}) {
+    Point blockSize(detail::dumpBlockSize(table.width(), options.maxWidth),
+            detail::dumpBlockSize(table.height(), options.maxHeight));
+    auto cellValue = [&](Point p) {
+            return blockSize == p11 ? table[p] : detail::dumpBlockValue(
+                    table, Point(p.x * blockSize.x, p.y * blockSize.y),
+                    blockSize, detail::IsLessThanComparable<T>{});
+        };
+    Point size((table.width() + blockSize.x - 1) / blockSize.x,
+            (table.height() + blockSize.y - 1) / blockSize.y);
+
+    std::size_t maxlen = 0;
+    for (Point p : PointRange{p00, size}) {
+        maxlen = std::max(maxlen, detail::convertedSize(converter,
+                cellValue(p)));
     }
     // leave a space between characters
     ++maxlen;
+
+    // The escapes have a constant length, so they are copied without a call.
+    static const char red[] = "\e[0;31m";
+    static const char yellow[] = "\e[0;33m";
+    static const char reset[] = "\e[0m";
+    constexpr std::size_t colourSize = sizeof(red) - 1;
+    constexpr std::size_t resetSize = sizeof(reset) - 1;
+    std::string indentString(options.indent, ' ');
+    std::string header;
+    if (!options.title.empty()) {
+        header += indentString + options.title + "\n";
+    }
+    if (blockSize != p11) {
+        header += indentString + "(" + std::to_string(blockSize.x) + "x" +
+                std::to_string(blockSize.y) + " blocks)\n";
+    }
+
+    // The exact size of the output, so that it is formatted in place.
+    std::size_t highlightedRows = (size.y + 4) / 5;
+    std::size_t highlightedCells = options.colour ?
+            highlightedRows * size.x +
+            (size.y - highlightedRows) * ((size.x + 4) / 5) : 0;
+    std::string result(header.size() +
+            size.y * (indentString.size() + size.x * maxlen + 1) + 1 +
+            highlightedCells * (colourSize + resetSize), '\0');
+    char* out = detail::appendText(&result[0], header);
     Point p;
-    for (p.y = 0; p.y < static_cast<int>(table.height()); p.y++) {
-        file << indentString;
-        for (p.x = 0; p.x < static_cast<int>(table.width()); p.x++) {
-            if (p.x % 10 == 0 || p.y % 10 == 0) {
-                file << "\e[0;31m";
-            } else if (p.x % 5 == 0 || p.y % 5 == 0) {
-                file << "\e[0;33m";
+    for (p.y = 0; p.y < size.y; p.y++) {
+        out = detail::appendText(out, indentString);
+        for (p.x = 0; p.x < size.x; p.x++) {
+            bool highlighted = options.colour &&
+                    (p.x % 5 == 0 || p.y % 5 == 0);
+            if (highlighted) {
+                out = std::copy_n(p.x % 10 == 0 || p.y % 10 == 0 ?
+                        red : yellow, colourSize, out);
             }
-            file.width(maxlen);
-            file << txts[p];
-            file.width(0);
-            if (p.x % 5 == 0 || p.y % 5 == 0) {
-                file << "\e[0m";
+            out = detail::appendConverted(out, maxlen, converter,
+                    cellValue(p));
+            if (highlighted) {
+                out = std::copy_n(reset, resetSize, out);
             }
         }
-        file << std::endl;
+        *out++ = '\n';
     }
-    file << std::endl;
+    *out++ = '\n';
+    assert(out == &result[0] + result.size());
+    return result;
+}
+
+// Writes the matrix with a single write.
+template<typename T, typename Layout, typename Converter = ToString>
+void dumpMatrix(std::ostream& file, const Matrix<T, Layout>& table,
+        const DumpOptions& options, const Converter& converter = Converter{}) {
+    std::string text = renderMatrix(table, options, converter);
+    file.write(text.data(), text.size());
+    file.flush();
+}
+
+template<typename T, typename Layout, typename Converter = ToString>
+void dumpMatrix(std::ostream& file, const Matrix<T, Layout>& table,
+        const std::string& title = "", int indent = 0,
+        const Converter& converter = Converter{}) {
+    DumpOptions options;
+    options.title = title;
+    options.indent = indent;
+    dumpMatrix(file, table, options, converter);
 }
 
 
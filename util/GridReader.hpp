@@ -0,0 +1,278 @@
+#ifndef UTIL_GRIDREADER_HPP
+#define UTIL_GRIDREADER_HPP
+
+#include "MappedFile.hpp"
+#include "Matrix.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+enum class GridFormat {
+    // Characters for char matrices, numbers for anything else.
+    automatic,
+    // Every character is a cell, like the creep maps.
+    characters,
+    // Every character is a one digit number, like "1123".
+    digits,
+    // Numbers separated by whitespace.
+    numbers
+};
+
+struct GridOptions {
+    // 0 means the number of cells in the longest line.
+    std::size_t width = 0;
+    // 0 means until the first empty line or the end of the input.
+    std::size_t height = 0;
+    // The first line is the bottom row.
+    bool flip = false;
+    char delimiter = '\n';
+    GridFormat format = GridFormat::automatic;
+    // The size of the grid is written here if set.
+    std::ostream* log = nullptr;
+};
+
+namespace detail {
+
+struct GridLine {
+    const char* begin;
+    const char* end;
+
+    std::size_t size() const { return end - begin; }
+};
+
+// The line ends are found with memchr(), which is vectorized in the C
+// library, so nothing is copied.
+inline
+std::vector<GridLine> splitGridLines(const char* begin, const char* end,
+        std::size_t height, char delimiter) {
+    std::vector<GridLine> lines;
+    if (height != 0) {
+        lines.reserve(height);
+    }
+    while (begin != end && (height == 0 || lines.size() != height)) {
+        auto lineEnd = static_cast<const char*>(
+                std::memchr(begin, delimiter, end - begin));
+        if (lineEnd == nullptr) {
+            lineEnd = end;
+        }
+        if (lineEnd == begin) {
+            break;
+        }
+        lines.push_back(GridLine{begin, lineEnd});
+        begin = lineEnd == end ? end : lineEnd + 1;
+    }
+    return lines;
+}
+
+// Writes the cells of one row. Rows of a row major matrix are contiguous, so
+// the conversion loops run over plain pointers and can be vectorized.
+template<typename T, typename Layout,
+        bool contiguous = std::is_same<Layout, RowMajorLayout>::value &&
+                !std::is_same<T, bool>::value>
+class GridRowWriter {
+public:
+    GridRowWriter(Matrix<T, Layout>& matrix, int y): matrix(matrix), y(y) {}
+
+    template<typename Value>
+    void set(std::size_t x, Value value) {
+        matrix[Point(x, y)] = value;
+    }
+
+    template<typename Function>
+    void convert(const char* begin, std::size_t size, Function function) {
+        for (std::size_t x = 0; x < size; ++x) {
+            set(x, function(begin[x]));
+        }
+    }
+private:
+    Matrix<T, Layout>& matrix;
+    int y;
+};
+
+template<typename T, typename Layout>
+class GridRowWriter<T, Layout, true> {
+public:
+    GridRowWriter(Matrix<T, Layout>& matrix, int y):
+        row(&matrix[Point(0, y)]) {}
+
+    template<typename Value>
+    void set(std::size_t x, Value value) {
+        row[x] = value;
+    }
+
+    template<typename Function>
+    void convert(const char* begin, std::size_t size, Function function) {
+        for (std::size_t x = 0; x < size; ++x) {
+            row[x] = function(begin[x]);
+        }
+    }
+private:
+    T* row;
+};
+
+inline
+bool isGridSpace(char c) {
+    return (c == ' ') | (c == '\t') | (c == '\r');
+}
+
+template<typename T>
+const char* parseGridNumber(const char* begin, const char* end, T& value,
+        std::true_type /*isIntegral*/) {
+    const char* p = begin;
+    bool negative = p != end && *p == '-';
+    if (negative) {
+        ++p;
+    }
+    const char* digitsBegin = p;
+    typename std::conditional<std::is_signed<T>::value, long long,
+            unsigned long long>::type result = 0;
+    for (; p != end && static_cast<unsigned char>(*p - '0') <= 9; ++p) {
+        result = result * 10 + (*p - '0');
+    }
+    if (p == digitsBegin) {
+        return begin;
+    }
+    value = static_cast<T>(negative ? -result : result);
+    return p;
+}
+
+template<typename T>
+const char* parseGridNumber(const char* begin, const char* end, T& value,
+        std::false_type /*isIntegral*/) {
+    char buffer[64];
+    std::size_t size = std::min<std::size_t>(end - begin, sizeof(buffer) - 1);
+    std::memcpy(buffer, begin, size);
+    buffer[size] = 0;
+    char* parsedEnd;
+    double result = std::strtod(buffer, &parsedEnd);
+    if (parsedEnd == buffer) {
+        return begin;
+    }
+    value = static_cast<T>(result);
+    return begin + (parsedEnd - buffer);
+}
+
+template<typename T, typename Writer>
+void parseNumberRow(const char* begin, const char* end, std::size_t width,
+        Writer& writer) {
+    // Single digits separated by single spaces: validated and converted in
+    // one branchless loop.
+    if (std::is_integral<T>::value && width != 0 &&
+            static_cast<std::size_t>(end - begin) == 2 * width - 1) {
+        unsigned bad = 0;
+        for (std::size_t x = 0; x < width; ++x) {
+            unsigned digit = static_cast<unsigned char>(begin[2 * x] - '0');
+            bad |= digit > 9;
+            bad |= x + 1 != width && begin[2 * x + 1] != ' ';
+        }
+        if (bad == 0) {
+            for (std::size_t x = 0; x < width; ++x) {
+                writer.set(x, static_cast<T>(begin[2 * x] - '0'));
+            }
+            return;
+        }
+    }
+    const char* p = begin;
+    for (std::size_t x = 0; x < width; ++x) {
+        while (p != end && isGridSpace(*p)) {
+            ++p;
+        }
+        T value;
+        const char* next = parseGridNumber(p, end, value,
+                std::is_integral<T>{});
+        if (next == p) {
+            return;
+        }
+        writer.set(x, value);
+        p = next;
+    }
+}
+
+// Counts the starts of the numbers. Every position is checked independently
+// of the others, so the loop can be vectorized.
+inline
+std::size_t countGridNumbers(const GridLine& line) {
+    std::size_t size = line.size();
+    if (size == 0) {
+        return 0;
+    }
+    const char* p = line.begin;
+    std::size_t result = !isGridSpace(p[0]);
+    for (std::size_t i = 1; i < size; ++i) {
+        result += isGridSpace(p[i - 1]) & !isGridSpace(p[i]);
+    }
+    return result;
+}
+
+template<typename T>
+GridFormat resolveGridFormat(GridFormat format) {
+    if (format != GridFormat::automatic) {
+        return format;
+    }
+    return std::is_same<T, char>::value ?
+            GridFormat::characters : GridFormat::numbers;
+}
+
+} // namespace detail
+
+// Parses a grid from memory directly into the result. Missing cells are
+// defaultValue.
+template<typename T, typename Layout = RowMajorLayout>
+Matrix<T, Layout> readGrid(const char* begin, const char* end,
+        const T& defaultValue = T{}, const GridOptions& options = {}) {
+    auto lines = detail::splitGridLines(begin, end, options.height,
+            options.delimiter);
+    GridFormat format = detail::resolveGridFormat<T>(options.format);
+    std::size_t width = options.width;
+    if (width == 0) {
+        for (const detail::GridLine& line : lines) {
+            width = std::max(width, format == GridFormat::numbers ?
+                    detail::countGridNumbers(line) : line.size());
+        }
+    }
+    std::size_t height = lines.size();
+    if (options.log) {
+        *options.log << width << ":" << height << "\n";
+    }
+
+    Matrix<T, Layout> result{width, height, defaultValue};
+    if (width == 0) {
+        // Only lines of spaces, there is not even a first cell to write to.
+        return result;
+    }
+    for (std::size_t i = 0; i < height; ++i) {
+        const detail::GridLine& line = lines[i];
+        int y = options.flip ? height - i - 1 : i;
+        detail::GridRowWriter<T, Layout> writer{result, y};
+        std::size_t size = std::min(width, line.size());
+        switch (format) {
+        case GridFormat::characters:
+            writer.convert(line.begin, size,
+                    [](char c) { return static_cast<T>(c); });
+            break;
+        case GridFormat::digits:
+            writer.convert(line.begin, size,
+                    [](char c) { return static_cast<T>(c - '0'); });
+            break;
+        default:
+            detail::parseNumberRow<T>(line.begin, line.end, width, writer);
+            break;
+        }
+    }
+    return result;
+}
+
+template<typename T, typename Layout = RowMajorLayout>
+Matrix<T, Layout> readGridFile(const std::string& fileName,
+        const T& defaultValue = T{}, const GridOptions& options = {}) {
+    MappedFile file{fileName};
+    return readGrid<T, Layout>(file.begin(), file.end(), defaultValue,
+            options);
+}
+
+#endif // UTIL_GRIDREADER_HPP
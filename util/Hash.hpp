@@ -1,7 +1,10 @@
 #ifndef HASH_HPP_
 #define HASH_HPP_
 
+#include <cstdint>
+#include <cstring>
 #include <functional>
+#include <type_traits>
 
 template <class T>
 inline void hash_combine(std::size_t& seed, const T& v)
@@ -10,7 +13,74 @@ inline void hash_combine(std::size_t& seed, const T& v)
     seed ^= hasher(v) + 0x9e3779b9 + (seed<<6) + (seed>>2);
 }
 
+namespace detail {
 
+constexpr std::uint64_t hashPrime0 = 0xa0761d6478bd642full;
+constexpr std::uint64_t hashPrime1 = 0xe7037ed1a0b428dbull;
+constexpr std::uint64_t hashPrime2 = 0x8ebc6af09c88c6e3ull;
+constexpr std::uint64_t hashPrime3 = 0x589965cc75374cc3ull;
 
+// The high and low halves of the 128 bit product folded together.
+inline std::uint64_t hashMix(std::uint64_t a, std::uint64_t b)
+{
+    unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    return static_cast<std::uint64_t>(product) ^
+            static_cast<std::uint64_t>(product >> 64);
+}
+
+inline std::uint64_t hashRead64(const unsigned char* p)
+{
+    std::uint64_t result;
+    std::memcpy(&result, p, sizeof(result));
+    return result;
+}
+
+} // namespace detail
+
+// 64 bit hash of a block of memory in the style of wyhash. The main loop
+// consumes 32 bytes in four independent lanes, so the multiplications of the
+// lanes overlap.
+inline std::uint64_t hashBytes(const void* data, std::size_t size,
+        std::uint64_t seed = 0)
+{
+    using namespace detail;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    std::uint64_t lanes[4] = {seed ^ hashPrime0, seed ^ hashPrime1,
+            seed ^ hashPrime2, seed ^ hashPrime3};
+    std::size_t remaining = size;
+    for (; remaining >= 32; remaining -= 32, p += 32) {
+        for (int i = 0; i < 4; ++i) {
+            lanes[i] = hashMix(hashRead64(p + 8 * i) ^ hashPrime1,
+                    lanes[i] ^ hashPrime0);
+        }
+    }
+    std::uint64_t result = hashMix(lanes[0] ^ lanes[2], lanes[1] ^ lanes[3]) ^
+            hashPrime2;
+    for (; remaining >= 8; remaining -= 8, p += 8) {
+        result = hashMix(hashRead64(p) ^ hashPrime1, result ^ hashPrime0);
+    }
+    if (remaining != 0) {
+        std::uint64_t tail = 0;
+        std::memcpy(&tail, p, remaining);
+        result = hashMix(tail ^ hashPrime1, result ^ hashPrime0);
+    }
+    return hashMix(result ^ size, hashPrime3);
+}
+
+// Types whose equal values have equal bytes, so that arrays of them can be
+// hashed with hashBytes().
+template <typename T>
+struct IsBytewiseHashable: std::integral_constant<bool,
+        (std::is_integral<T>::value && !std::is_same<T, bool>::value) ||
+        std::is_enum<T>::value> {};
+
+// Hash of two 32 bit values with a single multiplication. The high bits of
+// the product depend on all the input bits and are folded into the low ones.
+inline std::uint64_t hashPair(std::uint32_t a, std::uint32_t b)
+{
+    std::uint64_t product = ((static_cast<std::uint64_t>(a) << 32) | b) *
+            0x9e3779b97f4a7c15ull;
+    return product ^ (product >> 32);
+}
 
 #endif /* HASH_HPP_ */
@@ -0,0 +1,72 @@
+#include "MappedFile.hpp"
+
+#include <cerrno>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+std::system_error systemError(const std::string& what) {
+    return std::system_error{errno, std::system_category(), what};
+}
+
+} // unnamed namespace
+
+MappedFile::MappedFile(const std::string& fileName) {
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw systemError("Cannot open " + fileName);
+    }
+    struct stat fileStatus;
+    if (::fstat(fd, &fileStatus) < 0) {
+        auto error = systemError("Cannot stat " + fileName);
+        ::close(fd);
+        throw error;
+    }
+    size_ = fileStatus.st_size;
+    // mmap() does not accept an empty mapping.
+    if (size_ != 0) {
+        void* address = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED) {
+            auto error = systemError("Cannot map " + fileName);
+            ::close(fd);
+            throw error;
+        }
+        ::madvise(address, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(address);
+    }
+    ::close(fd);
+}
+
+MappedFile::MappedFile(MappedFile&& other):
+    data_(other.data_), size_(other.size_)
+{
+    other.data_ = nullptr;
+    other.size_ = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) {
+    if (this != &other) {
+        unmap();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    unmap();
+}
+
+void MappedFile::unmap() {
+    if (data_ != nullptr) {
+        ::munmap(const_cast<char*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
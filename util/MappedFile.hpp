@@ -0,0 +1,31 @@
+#ifndef UTIL_MAPPEDFILE_HPP
+#define UTIL_MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file. Throws std::system_error if the
+// file cannot be opened or mapped.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& fileName);
+    MappedFile(MappedFile&& other);
+    MappedFile& operator=(MappedFile&& other);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* begin() const { return data_; }
+    const char* end() const { return data_ + size_; }
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    void unmap();
+
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+#endif // UTIL_MAPPEDFILE_HPP
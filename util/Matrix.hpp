@@ -9,6 +9,7 @@
 #include <boost/range/algorithm.hpp>
 #include <boost/serialization/vector.hpp>
 
+#include <algorithm>
 #include <assert.h>
 #include <type_traits>
 #include <vector>
@@ -19,21 +20,71 @@ inline bool isInsideMatrix(const Matrix& matrix, Point p) {
             p.y < static_cast<int>(matrix.height());
 }
 
-template<typename T>
+// Cells stored row after row.
+class RowMajorLayout {
+public:
+    RowMajorLayout(std::size_t width, std::size_t /*height*/):
+        width_(width)
+    {}
+
+    std::size_t operator()(Point p) const {
+        return p.y*width_ + p.x;
+    }
+private:
+    std::size_t width_;
+};
+
+// Cells stored in TileSize x TileSize tiles, each tile row after row, so that
+// the cells of a small square neighborhood share a few cache lines. The tiles
+// at the right and bottom edges are smaller, so there is no padding and the
+// storage holds exactly width * height cells.
+template<std::size_t TileSize = 8>
+class TiledLayout {
+    static_assert(TileSize != 0 && (TileSize & (TileSize - 1)) == 0,
+            "Tile size must be a power of two.");
+public:
+    TiledLayout(std::size_t width, std::size_t height):
+        width_(width), height_(height)
+    {}
+
+    std::size_t operator()(Point p) const {
+        std::size_t x = p.x;
+        std::size_t y = p.y;
+        std::size_t bandBegin = y & ~(TileSize - 1);
+        std::size_t tileBegin = x & ~(TileSize - 1);
+        if (tileBegin + TileSize <= width_ && bandBegin + TileSize <= height_) {
+            return bandBegin*width_ + tileBegin*TileSize +
+                    (y - bandBegin)*TileSize + (x - tileBegin);
+        }
+        std::size_t bandHeight = std::min(TileSize, height_ - bandBegin);
+        std::size_t tileWidth = std::min(TileSize, width_ - tileBegin);
+        return bandBegin*width_ + tileBegin*bandHeight +
+                (y - bandBegin)*tileWidth + (x - tileBegin);
+    }
+private:
+    std::size_t width_, height_;
+};
+
+// Layout maps a Point to the position of the cell in the storage. The
+// iterators and operator[](std::size_t) go in storage order.
+template<typename T, typename Layout = RowMajorLayout>
 class Matrix {
     typedef std::vector<T> Data;
     std::size_t width_, height_;
+    Layout layout_;
     Data data_;
 public:
     typedef T valueType;
+    typedef Layout layoutType;
     typedef typename Data::reference reference;
     typedef typename Data::const_reference const_reference;
     typedef typename Data::iterator iterator;
     typedef typename Data::const_iterator const_iterator;
 
-    Matrix(): width_(0), height_(0) {}
+    Matrix(): width_(0), height_(0), layout_(0, 0) {}
     Matrix(std::size_t width, std::size_t height, const T& defValue = T()):
-        width_(width), height_(height), data_(width * height, defValue)
+        width_(width), height_(height), layout_(width, height),
+        data_(width * height, defValue)
     {}
     Matrix(const Matrix& ) = default;
     Matrix(Matrix&& ) = default;
@@ -49,11 +100,11 @@ public:
     }
     reference operator[](Point p) {
         assert(isInsideMatrix(*this, p));
-        return data_[p.y*width_ + p.x];
+        return data_[layout_(p)];
     }
     const_reference operator[](Point p) const {
         assert(isInsideMatrix(*this, p));
-        return data_[p.y*width_ + p.x];
+        return data_[layout_(p)];
     }
     std::size_t size() const { return data_.size(); }
     std::size_t width() const { return width_; }
@@ -63,6 +114,7 @@ public:
     {
         width_ = newWidth;
         height_ = newHeight;
+        layout_ = Layout{width_, height_};
         data_.resize(width_ * height_);
         fill(defValue);
     }
@@ -75,9 +127,10 @@ public:
         data_.clear();
         width_ = 0;
         height_ = 0;
+        layout_ = Layout{0, 0};
     }
 
-    bool operator==(const Matrix<T>& other) const
+    bool operator==(const Matrix& other) const
     {
         return data_ == other.data_;
     }
@@ -94,12 +147,13 @@ public:
         ar & width_;
         ar & height_;
         ar & data_;
+        layout_ = Layout{width_, height_};
     }
 };
 
-template<typename T>
-inline const typename Matrix<T>::const_reference matrixAt(const Matrix<T> &arr,
-        Point p, const T& def) {
+template<typename T, typename Layout>
+inline const typename Matrix<T, Layout>::const_reference matrixAt(
+        const Matrix<T, Layout> &arr, Point p, const T& def) {
     return isInsideMatrix(arr, p) ? arr[p] : def;
 }
 
@@ -108,15 +162,26 @@ inline PointRange matrixRange(const Matrix& matrix) {
     return PointRange(Point(0,0), Point(matrix.width(), matrix.height()));
 }
 
-template<typename T>
-inline bool operator!=(const Matrix<T>& lhs, const Matrix<T>& rhs) {
+template<typename T, typename Layout>
+inline bool operator!=(const Matrix<T, Layout>& lhs,
+        const Matrix<T, Layout>& rhs) {
     return !(lhs == rhs);
 }
 
 namespace std {
-template<typename T>
-struct hash<Matrix<T>> {
-    size_t operator()(const Matrix<T>& arr) const {
+template<typename T, typename Layout>
+struct hash<Matrix<T, Layout>> {
+    size_t operator()(const Matrix<T, Layout>& arr) const {
+        return hashCells(arr, IsBytewiseHashable<T>{});
+    }
+
+private:
+    // The cells are contiguous in storage order.
+    size_t hashCells(const Matrix<T, Layout>& arr, std::true_type) const {
+        return arr.size() == 0 ? hashBytes(nullptr, 0) :
+                hashBytes(&arr[0], arr.size() * sizeof(T));
+    }
+    size_t hashCells(const Matrix<T, Layout>& arr, std::false_type) const {
         size_t seed = 0;
         for (size_t i = 0; i < arr.size(); ++i) {
             hash_combine(seed, arr[i]);
@@ -0,0 +1,47 @@
+#include "MatrixFile.hpp"
+
+#include <algorithm>
+
+namespace detail {
+
+void checkMatrixFileHeader(const MatrixFileHeader& header,
+        const MatrixFileHeader& expected, std::size_t dataSize) {
+    if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0) {
+        throw MatrixFileError{"Not a matrix file."};
+    }
+    if (header.byteOrder != expected.byteOrder) {
+        throw MatrixFileError{"Matrix file has a different byte order."};
+    }
+    if (header.version != expected.version) {
+        throw MatrixFileError{"Unsupported matrix file version " +
+                std::to_string(header.version) + "."};
+    }
+    if (header.elementType != expected.elementType ||
+            header.elementSize != expected.elementSize) {
+        throw MatrixFileError{"Matrix file has a different element type."};
+    }
+    if (header.layout != expected.layout ||
+            header.tileSize != expected.tileSize) {
+        throw MatrixFileError{"Matrix file has a different layout."};
+    }
+    if (header.elementSize != 0 && header.width != 0 &&
+            header.height > dataSize / header.elementSize / header.width) {
+        throw MatrixFileError{"Matrix file is too short."};
+    }
+}
+
+std::vector<char> readStreamData(std::istream& is, std::size_t size) {
+    constexpr std::size_t minChunkSize = 1 << 20;
+    std::vector<char> result;
+    while (result.size() < size) {
+        std::size_t offset = result.size();
+        result.resize(offset + std::min(size - offset,
+                std::max(minChunkSize, offset)));
+        if (!is.read(&result[offset], result.size() - offset)) {
+            throw MatrixFileError{"Matrix file is too short."};
+        }
+    }
+    return result;
+}
+
+} // namespace detail
@@ -0,0 +1,322 @@
+#ifndef UTIL_MATRIXFILE_HPP
+#define UTIL_MATRIXFILE_HPP
+
+#include "MappedFile.hpp"
+#include "Matrix.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Binary matrix files: a MatrixFileHeader followed by the cells in storage
+// order, in the byte order of the machine that wrote them. The header is 64
+// bytes, so the cells of a mapped file are aligned and can be used in place.
+
+enum class MatrixElementType : std::uint32_t {
+    int8 = 1, uint8, int16, uint16, int32, uint32, int64, uint64,
+    float32, float64, character, point
+};
+
+struct MatrixFileHeader {
+    static constexpr std::uint32_t currentVersion = 1;
+    static constexpr std::uint32_t byteOrderMark = 0x01020304;
+
+    char magic[8];
+    std::uint32_t byteOrder;
+    std::uint32_t version;
+    std::uint32_t elementType;
+    std::uint32_t elementSize;
+    // 0: RowMajorLayout, 1: TiledLayout<tileSize>
+    std::uint32_t layout;
+    std::uint32_t tileSize;
+    std::uint64_t width;
+    std::uint64_t height;
+    char reserved[16];
+};
+static_assert(sizeof(MatrixFileHeader) == 64, "Unexpected header size.");
+
+class MatrixFileError: public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+namespace detail {
+
+constexpr MatrixElementType integerElementType(std::size_t size,
+        bool isSigned) {
+    return size == 1 ? (isSigned ? MatrixElementType::int8 :
+                    MatrixElementType::uint8) :
+            size == 2 ? (isSigned ? MatrixElementType::int16 :
+                    MatrixElementType::uint16) :
+            size == 4 ? (isSigned ? MatrixElementType::int32 :
+                    MatrixElementType::uint32) :
+                    (isSigned ? MatrixElementType::int64 :
+                    MatrixElementType::uint64);
+}
+
+template<typename T, typename Enable = void>
+struct MatrixElementTypeOf;
+
+template<typename T>
+struct MatrixElementTypeOf<T, typename std::enable_if<
+        std::is_integral<T>::value>::type> {
+    static constexpr MatrixElementType value = integerElementType(sizeof(T),
+            std::is_signed<T>::value);
+};
+
+// Enums are stored as their underlying type.
+template<typename T>
+struct MatrixElementTypeOf<T, typename std::enable_if<
+        std::is_enum<T>::value>::type>:
+        MatrixElementTypeOf<typename std::underlying_type<T>::type> {};
+
+template<>
+struct MatrixElementTypeOf<char> {
+    static constexpr MatrixElementType value = MatrixElementType::character;
+};
+
+template<>
+struct MatrixElementTypeOf<float> {
+    static constexpr MatrixElementType value = MatrixElementType::float32;
+};
+
+template<>
+struct MatrixElementTypeOf<double> {
+    static constexpr MatrixElementType value = MatrixElementType::float64;
+};
+
+template<>
+struct MatrixElementTypeOf<Point> {
+    static constexpr MatrixElementType value = MatrixElementType::point;
+};
+
+template<typename Layout>
+struct MatrixLayoutOf;
+
+template<>
+struct MatrixLayoutOf<RowMajorLayout> {
+    static constexpr std::uint32_t layout = 0;
+    static constexpr std::uint32_t tileSize = 0;
+};
+
+template<std::size_t TileSize>
+struct MatrixLayoutOf<TiledLayout<TileSize>> {
+    static constexpr std::uint32_t layout = 1;
+    static constexpr std::uint32_t tileSize = TileSize;
+};
+
+template<typename T, typename Layout>
+MatrixFileHeader createMatrixFileHeader(std::size_t width,
+        std::size_t height) {
+    static_assert(!std::is_same<T, bool>::value,
+            "Matrix<bool> has no contiguous storage, use BitMatrix.");
+    static_assert(std::is_trivially_copyable<T>::value,
+            "Only trivially copyable cells can be stored.");
+    MatrixFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "MATRIX\0\0", sizeof(header.magic));
+    header.byteOrder = MatrixFileHeader::byteOrderMark;
+    header.version = MatrixFileHeader::currentVersion;
+    header.elementType = static_cast<std::uint32_t>(
+            MatrixElementTypeOf<T>::value);
+    header.elementSize = sizeof(T);
+    header.layout = MatrixLayoutOf<Layout>::layout;
+    header.tileSize = MatrixLayoutOf<Layout>::tileSize;
+    header.width = width;
+    header.height = height;
+    return header;
+}
+
+// Throws MatrixFileError if the header read does not describe a matrix of the
+// expected type or there are less than dataSize bytes of cells after it.
+void checkMatrixFileHeader(const MatrixFileHeader& header,
+        const MatrixFileHeader& expected, std::size_t dataSize);
+
+// The size of the cells described by a header that checkMatrixFileHeader()
+// accepted. Throws MatrixFileError if it does not fit in a size_t, so that a
+// broken header cannot wrap it around to a small number.
+inline
+std::size_t matrixDataSize(const MatrixFileHeader& header) {
+    constexpr std::size_t maxSize = std::numeric_limits<std::size_t>::max();
+    if (header.width > maxSize || header.height > maxSize ||
+            (header.width != 0 && header.height >
+                    maxSize / header.elementSize / header.width)) {
+        throw MatrixFileError{"Matrix file is too big."};
+    }
+    return header.width * header.height * header.elementSize;
+}
+
+constexpr std::size_t unknownStreamSize =
+        std::numeric_limits<std::size_t>::max();
+
+// The number of bytes after the read position, or unknownStreamSize if the
+// stream cannot seek, like a pipe.
+inline
+std::size_t remainingStreamSize(std::istream& is) {
+    auto position = is.tellg();
+    if (position == std::istream::pos_type(-1)) {
+        is.clear();
+        return unknownStreamSize;
+    }
+    is.seekg(0, std::ios::end);
+    auto end = is.tellg();
+    is.clear();
+    is.seekg(position);
+    if (end == std::istream::pos_type(-1) || end < position) {
+        return unknownStreamSize;
+    }
+    return static_cast<std::size_t>(end - position);
+}
+
+// Reads size bytes from a stream of unknown size. The buffer grows with what
+// was read, so a header cannot make it allocate much more than the stream
+// has. Throws MatrixFileError if the stream ends first.
+std::vector<char> readStreamData(std::istream& is, std::size_t size);
+
+template<typename T, typename Layout>
+MatrixFileHeader readMatrixFileHeader(const char* begin, std::size_t size) {
+    if (size < sizeof(MatrixFileHeader)) {
+        throw MatrixFileError{"Matrix file is too short."};
+    }
+    MatrixFileHeader header;
+    std::memcpy(&header, begin, sizeof(header));
+    checkMatrixFileHeader(header,
+            createMatrixFileHeader<T, Layout>(header.width, header.height),
+            size - sizeof(header));
+    return header;
+}
+
+} // namespace detail
+
+// Read-only matrix over memory owned by someone else.
+template<typename T, typename Layout = RowMajorLayout>
+class MatrixView {
+public:
+    typedef T valueType;
+    typedef Layout layoutType;
+    typedef const T& const_reference;
+    typedef const T* const_iterator;
+
+    MatrixView(): data_(nullptr), width_(0), height_(0), layout_(0, 0) {}
+    MatrixView(const T* data, std::size_t width, std::size_t height):
+        data_(data), width_(width), height_(height), layout_(width, height)
+    {}
+    MatrixView(const Matrix<T, Layout>& matrix):
+        MatrixView(matrix.size() != 0 ? &matrix[0] : nullptr,
+                matrix.width(), matrix.height())
+    {}
+
+    const_reference operator[](std::size_t pos) const {
+        assert(pos < size());
+        return data_[pos];
+    }
+    const_reference operator[](Point p) const {
+        assert(isInsideMatrix(*this, p));
+        return data_[layout_(p)];
+    }
+    std::size_t size() const { return width_ * height_; }
+    std::size_t width() const { return width_; }
+    std::size_t height() const { return height_; }
+    const T* data() const { return data_; }
+
+    const_iterator begin() const { return data_; }
+    const_iterator end() const { return data_ + size(); }
+
+    Matrix<T, Layout> toMatrix() const {
+        Matrix<T, Layout> result{width_, height_};
+        std::copy(begin(), end(), result.begin());
+        return result;
+    }
+
+private:
+    const T* data_;
+    std::size_t width_, height_;
+    Layout layout_;
+};
+
+// A matrix file mapped into memory. The cells are used without a copy.
+template<typename T, typename Layout = RowMajorLayout>
+class MappedMatrix {
+public:
+    explicit MappedMatrix(const std::string& fileName): file_(fileName) {
+        auto header = detail::readMatrixFileHeader<T, Layout>(file_.data(),
+                file_.size());
+        view_ = MatrixView<T, Layout>{reinterpret_cast<const T*>(
+                        file_.data() + sizeof(MatrixFileHeader)),
+                header.width, header.height};
+    }
+
+    const MatrixView<T, Layout>& view() const { return view_; }
+    const T& operator[](Point p) const { return view_[p]; }
+    std::size_t width() const { return view_.width(); }
+    std::size_t height() const { return view_.height(); }
+
+private:
+    MappedFile file_;
+    MatrixView<T, Layout> view_;
+};
+
+template<typename T, typename Layout>
+void writeMatrix(std::ostream& os, const Matrix<T, Layout>& matrix) {
+    auto header = detail::createMatrixFileHeader<T, Layout>(matrix.width(),
+            matrix.height());
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (matrix.size() != 0) {
+        os.write(reinterpret_cast<const char*>(&matrix[0]),
+                matrix.size() * sizeof(T));
+    }
+}
+
+template<typename T, typename Layout = RowMajorLayout>
+Matrix<T, Layout> readMatrix(std::istream& is) {
+    MatrixFileHeader header;
+    if (!is.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        throw MatrixFileError{"Matrix file is too short."};
+    }
+    std::size_t remainingSize = detail::remainingStreamSize(is);
+    detail::checkMatrixFileHeader(header,
+            detail::createMatrixFileHeader<T, Layout>(header.width,
+                    header.height),
+            remainingSize);
+    std::size_t dataSize = detail::matrixDataSize(header);
+    if (remainingSize == detail::unknownStreamSize) {
+        // A stream that cannot seek is only known to be too short when the
+        // read fails, so the cells are read before the matrix is allocated.
+        std::vector<char> data = detail::readStreamData(is, dataSize);
+        Matrix<T, Layout> result{header.width, header.height};
+        if (dataSize != 0) {
+            std::memcpy(&result[0], data.data(), dataSize);
+        }
+        return result;
+    }
+    Matrix<T, Layout> result{header.width, header.height};
+    if (dataSize != 0 &&
+            !is.read(reinterpret_cast<char*>(&result[0]), dataSize)) {
+        throw MatrixFileError{"Matrix file is too short."};
+    }
+    return result;
+}
+
+template<typename T, typename Layout>
+void saveMatrixFile(const std::string& fileName,
+        const Matrix<T, Layout>& matrix) {
+    std::ofstream file{fileName, std::ios::binary};
+    writeMatrix(file, matrix);
+    if (!file) {
+        throw MatrixFileError{"Cannot write " + fileName};
+    }
+}
+
+template<typename T, typename Layout = RowMajorLayout>
+Matrix<T, Layout> loadMatrixFile(const std::string& fileName) {
+    return MappedMatrix<T, Layout>{fileName}.view().toMatrix();
+}
+
+#endif // UTIL_MATRIXFILE_HPP
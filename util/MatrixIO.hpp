@@ -1,78 +1,47 @@
 #include "Matrix.hpp"
 #include "DumperFunctions.hpp"
+#include "GridReader.hpp"
 
-#include <boost/range/adaptor/transformed.hpp>
-#include <boost/range/algorithm/max_element.hpp>
-
-#include <algorithm>
-#include <functional>
 #include <istream>
 #include <ostream>
-#include <sstream>
 #include <string>
 
-namespace detail {
-
-template<typename T>
-void readValue(std::istream& s, T& t) {
-    s >> t;
-}
-
-inline
-void readValue(std::istream& s, char& c) {
-    s.get(c);
-}
-
-}
-
-template<typename T>
-std::ostream& operator<<(std::ostream& os, const Matrix<T>& matrix) {
+template<typename T, typename Layout>
+std::ostream& operator<<(std::ostream& os, const Matrix<T, Layout>& matrix) {
     dumpMatrix(os, matrix, " ");
     return os;
 }
 
-template<typename T>
-Matrix<T> loadMatrix(std::istream& is, const T& defaultValue = T{},
+// Reads the lines up to the first empty one into a single buffer and parses
+// it with readGrid(). Use readGridFile() to read a whole file without copying.
+template<typename T, typename Layout = RowMajorLayout>
+Matrix<T, Layout> loadMatrix(std::istream& is, const T& defaultValue = T{},
         std::size_t width = 0, std::size_t height = 0, bool flip = false,
         char delimiter = '\n') {
-    std::vector<std::string> lines;
+    std::string buffer;
     std::string line;
-    while (is.good() && (height == 0 || lines.size() != height)) {
+    std::size_t lineCount = 0;
+    while (is.good() && (height == 0 || lineCount != height)) {
         std::getline(is, line, delimiter);
-        std::cerr << "--> " << line << "\n";
         if (line.empty()) {
             break;
         }
-        lines.push_back(line);
-    }
-    if (flip) {
-        std::reverse(lines.begin(), lines.end());
-    }
-
-    height = lines.size();
-    if (width == 0) {
-        std::function<std::size_t(const std::string&)> sizeGetter =
-                [](const std::string& s) { return s.size(); };
-        width = height != 0 ?
-                *boost::max_element(lines | boost::adaptors::transformed(
-                        sizeGetter)) : 0;
-    }
-    std::cerr << width << ":" << height << "\n";
-    Matrix<T> result{width, height, defaultValue};
-    Point p;
-    for (p.y = 0; p.y < static_cast<int>(height); ++p.y) {
-        std::istringstream ss{lines[p.y]};
-        for (p.x = 0; p.x < static_cast<int>(width) && ss.good(); ++p.x) {
-            detail::readValue(ss, result[p]);
-        }
+        buffer += line;
+        buffer += delimiter;
+        ++lineCount;
     }
 
-    return result;
+    GridOptions options;
+    options.width = width;
+    options.flip = flip;
+    options.delimiter = delimiter;
+    return readGrid<T, Layout>(buffer.data(), buffer.data() + buffer.size(),
+            defaultValue, options);
 }
 
-template<typename T>
-std::istream& operator>>(std::istream& is, Matrix<T>& matrix) {
-    matrix = loadMatrix<T>(is);
+template<typename T, typename Layout>
+std::istream& operator>>(std::istream& is, Matrix<T, Layout>& matrix) {
+    matrix = loadMatrix<T, Layout>(is);
     return is;
 }
 
@@ -1,17 +1,58 @@
 #pragma once
 
-#include <vector>
-#include <algorithm>
+#include <boost/container/static_vector.hpp>
+
 #include "Point.hpp"
 #include "Matrix.hpp"
 
-template <typename T>
-std::vector<Point> getNeigbors(const Matrix<T>& m, Point p) {
-    std::vector<Point> result = {p + p01, p - p01, p + p10, p - p10};
-    result.erase(std::remove_if(result.begin(), result.end(), [&m](auto& p) {
-                     return !isInsideMatrix(m, p);
-                 }), result.end());
+// At most 8 neighbors, stored in place.
+typedef boost::container::static_vector<Point, 8> NeighborPoints;
+
+constexpr Point edgeNeighborOffsets[] = {p01, -p01, p10, -p10};
+constexpr Point diagonalNeighborOffsets[] = {p11, -p11, Point{1, -1},
+        Point{-1, 1}};
+constexpr Point surroundingNeighborOffsets[] = {p01, -p01, p10, -p10,
+        p11, -p11, Point{1, -1}, Point{-1, 1}};
+
+// The neighbors of an interior point are all inside the matrix, so they need
+// no bounds checks.
+template <typename Matrix>
+inline bool isInteriorPoint(const Matrix& m, Point p) {
+    return p.x > 0 && p.y > 0 && p.x + 1 < static_cast<int>(m.width()) &&
+            p.y + 1 < static_cast<int>(m.height());
+}
+
+template <typename Matrix, std::size_t N>
+NeighborPoints getNeigbors(const Matrix& m, Point p,
+        const Point (&offsets)[N]) {
+    static_assert(N <= NeighborPoints::static_capacity, "Too many offsets.");
+    NeighborPoints result;
+    if (isInteriorPoint(m, p)) {
+        for (Point offset : offsets) {
+            result.push_back(p + offset);
+        }
+    } else {
+        for (Point offset : offsets) {
+            if (isInsideMatrix(m, p + offset)) {
+                result.push_back(p + offset);
+            }
+        }
+    }
     return result;
 }
 
-// TODO getDiagonalNeigbors, getAllNeigbors
+template <typename T, typename Layout>
+NeighborPoints getNeigbors(const Matrix<T, Layout>& m, Point p) {
+    return getNeigbors(m, p, edgeNeighborOffsets);
+}
+
+template <typename T, typename Layout>
+NeighborPoints getDiagonalNeigbors(const Matrix<T, Layout>& m, Point p) {
+    return getNeigbors(m, p, diagonalNeighborOffsets);
+}
+
+// Edge and diagonal neighbors.
+template <typename T, typename Layout>
+NeighborPoints getSurroundingNeigbors(const Matrix<T, Layout>& m, Point p) {
+    return getNeigbors(m, p, surroundingNeighborOffsets);
+}
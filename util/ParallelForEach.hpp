@@ -0,0 +1,71 @@
+#ifndef UTIL_PARALLELFOREACH_HPP
+#define UTIL_PARALLELFOREACH_HPP
+
+#include "PointRange.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <vector>
+
+// Calls function for every point of the range, row after row. There is no
+// end of row check for every point, unlike with the iterators.
+template<typename Function>
+void forEachPoint(const PointRange& range, const Function& function) {
+    Point begin = range.topLeft();
+    Point end = begin + Point(range.width(), range.height());
+    Point p;
+    for (p.y = begin.y; p.y < end.y; ++p.y) {
+        for (p.x = begin.x; p.x < end.x; ++p.x) {
+            function(p);
+        }
+    }
+}
+
+// Splits the range into numThreads blocks of rows and calls function for
+// every point, each block in its own thread. The calling thread processes
+// the first block. The function must be safe to call concurrently for
+// different points. If it throws, the first exception is rethrown after
+// every thread finished.
+template<typename Function>
+void parallelForEach(const PointRange& range, const Function& function,
+        std::size_t numThreads = std::thread::hardware_concurrency()) {
+    auto blocks = range.splitRows(std::max<std::size_t>(numThreads, 1));
+    if (blocks.size() <= 1) {
+        forEachPoint(range, function);
+        return;
+    }
+    std::vector<std::exception_ptr> exceptions(blocks.size());
+    auto processBlock = [&](std::size_t i) {
+            try {
+                forEachPoint(blocks[i], function);
+            } catch (...) {
+                exceptions[i] = std::current_exception();
+            }
+        };
+    std::vector<std::thread> threads;
+    auto joinThreads = [&threads]() {
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+        };
+    try {
+        for (std::size_t i = 1; i < blocks.size(); ++i) {
+            threads.emplace_back(processBlock, i);
+        }
+    } catch (...) {
+        // A thread could not be started. Destroying the ones that run
+        // would terminate the program.
+        joinThreads();
+        throw;
+    }
+    processBlock(0);
+    joinThreads();
+    for (const std::exception_ptr& exception : exceptions) {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+}
+
+#endif // UTIL_PARALLELFOREACH_HPP
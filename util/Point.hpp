@@ -92,13 +92,13 @@ template<>
 struct hash<Point> {
     size_t operator()(Point p) const
     {
-        size_t seed = 0;
-        hash_combine(seed, p.x);
-        hash_combine(seed, p.y);
-        return seed;
+        return hashPair(p.x, p.y);
     }
 };
 
 } // namespace std
 
+template<>
+struct IsBytewiseHashable<Point>: std::true_type {};
+
 #endif /*POINT_H_*/
@@ -6,19 +6,24 @@
 #include <boost/iterator/iterator_facade.hpp>
 #include <boost/exception/all.hpp>
 
+#include <algorithm>
+#include <cstddef>
 #include <stdexcept>
+#include <vector>
 
 class PointRangeIterator;
 
+// The points of a rectangle, row after row. The iterators are random access
+// and a range can be split into blocks of rows to process them in parallel.
 class PointRange {
 public:
     typedef PointRangeIterator iterator;
+    typedef PointRangeIterator const_iterator;
 private:
     Point begin_;
     Point end_;
 public:
     typedef Point value_type;
-    friend class PointRangeIterator;
 
     PointRange(Point  begin, Point  end):
         begin_(begin),
@@ -41,14 +46,54 @@ public:
         }
         return Point(end_.x - 1, end_.y - 1);
     }
+
+    Point topLeft() const { return begin_; }
+    Point bottomRight() const { return end_; }
+    bool empty() const { return begin_.x >= end_.x || begin_.y >= end_.y; }
+    int width() const { return empty() ? 0 : end_.x - begin_.x; }
+    int height() const { return empty() ? 0 : end_.y - begin_.y; }
+    std::size_t size() const
+    {
+        return static_cast<std::size_t>(width()) * height();
+    }
+    Point operator[](std::size_t n) const
+    {
+        if (empty()) {
+            BOOST_THROW_EXCEPTION(std::out_of_range("operator[] cannot be called on empty PointRange."));
+        }
+        return Point(begin_.x + n % width(), begin_.y + n / width());
+    }
+
+    // The rows from first to last (exclusive), clipped to the range.
+    PointRange rows(int first, int last) const
+    {
+        first = std::max(first, begin_.y);
+        last = std::max(first, std::min(last, end_.y));
+        return PointRange(Point(begin_.x, first), Point(end_.x, last));
+    }
+    // At most count blocks of whole rows with about the same height.
+    std::vector<PointRange> splitRows(std::size_t count) const
+    {
+        std::vector<PointRange> result;
+        std::size_t rowCount = height();
+        count = std::min(count, rowCount);
+        for (std::size_t i = 0; i < count; ++i) {
+            result.push_back(rows(begin_.y + rowCount * i / count,
+                    begin_.y + rowCount * (i + 1) / count));
+        }
+        return result;
+    }
 }; // class PointRange
 
+// Holds the first and last column instead of pointing to the range, so it
+// stays valid after the range is gone.
 class PointRangeIterator: public boost::iterator_facade<
         PointRangeIterator,
         Point,
-        boost::bidirectional_traversal_tag,
+        boost::random_access_traversal_tag,
         Point > {
 public:
+    PointRangeIterator(): beginX_(0), endX_(0) {}
     PointRangeIterator(const PointRangeIterator&) = default;
     PointRangeIterator(PointRangeIterator&&) = default;
 
@@ -56,34 +101,53 @@ public:
     PointRangeIterator& operator=(PointRangeIterator&&) = default;
 
 private:
-    const PointRange* owner_;
     Point p_;
+    int beginX_;
+    int endX_;
 
     friend class PointRange;
     friend class boost::iterator_core_access;
 
-    PointRangeIterator(const PointRange& owner, Point  p):
-        owner_(&owner),
-        p_(p)
+    PointRangeIterator(Point p, int beginX, int endX):
+        p_(p),
+        beginX_(beginX),
+        endX_(endX)
     {}
     Point  dereference() const { return p_; }
     void increment()
     {
         ++p_.x;
-        if (p_.x == owner_->end_.x) {
-            p_.x = owner_->begin_.x;
+        if (p_.x == endX_) {
+            p_.x = beginX_;
             ++p_.y;
         }
     }
     void decrement()
     {
-        if (p_.x == owner_->begin_.x) {
-            p_.x = owner_->end_.x - 1;
+        if (p_.x == beginX_) {
+            p_.x = endX_ - 1;
             --p_.y;
         } else {
             --p_.x;
         }
     }
+    void advance(std::ptrdiff_t n)
+    {
+        std::ptrdiff_t width = endX_ - beginX_;
+        if (width == 0) {
+            return;
+        }
+        std::ptrdiff_t index = p_.x - beginX_ + n;
+        std::ptrdiff_t rows = index >= 0 ?
+                index / width : -((width - 1 - index) / width);
+        p_.y += rows;
+        p_.x = beginX_ + (index - rows * width);
+    }
+    std::ptrdiff_t distance_to(const PointRangeIterator& other) const
+    {
+        return static_cast<std::ptrdiff_t>(other.p_.y - p_.y) *
+                (endX_ - beginX_) + (other.p_.x - p_.x);
+    }
 
     bool equal(const PointRangeIterator& other) const
     {
@@ -94,13 +158,14 @@ private:
 inline
 PointRange::iterator PointRange::begin() const
 {
-    return iterator(*this, begin_);
+    return iterator(begin_, begin_.x, end_.x);
 }
 
 inline
 PointRange::iterator PointRange::end() const
 {
-    return iterator(*this, Point(begin_.x, end_.y));
+    return iterator(empty() ? begin_ : Point(begin_.x, end_.y), begin_.x,
+            end_.x);
 }
 
 
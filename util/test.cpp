@@ -0,0 +1,425 @@
+#include "BitMatrix.hpp"
+#include "MatrixFile.hpp"
+#include "MatrixIO.hpp"
+#include "NibbleMatrix.hpp"
+#include "ParallelForEach.hpp"
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <sstream>
+
+namespace {
+
+bool pattern(Point p) {
+    return (p.x * 7 + p.y * 3) % 5 < 2;
+}
+
+BitMatrix patternBits(std::size_t width, std::size_t height) {
+    BitMatrix result{width, height};
+    for (Point p : PointRange{p00, Point(width, height)}) {
+        result[p] = pattern(p);
+    }
+    return result;
+}
+
+std::size_t countPattern(std::size_t width, std::size_t height) {
+    std::size_t result = 0;
+    for (Point p : PointRange{p00, Point(width, height)}) {
+        result += pattern(p);
+    }
+    return result;
+}
+
+template<typename T, typename Layout = RowMajorLayout>
+Matrix<T, Layout> numberedMatrix(std::size_t width, std::size_t height) {
+    Matrix<T, Layout> result{width, height};
+    for (Point p : matrixRange(result)) {
+        result[p] = static_cast<T>(p.y * 100 + p.x);
+    }
+    return result;
+}
+
+// A stream buffer over a string that cannot seek, like a pipe.
+class PipeBuffer: public std::streambuf {
+public:
+    explicit PipeBuffer(std::string data): data_(std::move(data)) {
+        setg(&data_[0], &data_[0], &data_[0] + data_.size());
+    }
+
+private:
+    std::string data_;
+};
+
+// Reads the data from a string stream and from a pipe.
+template<typename T, typename Layout = RowMajorLayout>
+void expectReadError(const std::string& data, const std::string& message) {
+    std::istringstream ss{data};
+    PipeBuffer pipeBuffer{data};
+    std::istream pipe{&pipeBuffer};
+    for (std::istream* is : {static_cast<std::istream*>(&ss), &pipe}) {
+        try {
+            readMatrix<T, Layout>(*is);
+            ADD_FAILURE() << "No error, expected: " << message;
+        } catch (const MatrixFileError& e) {
+            EXPECT_EQ(message, e.what());
+        }
+    }
+}
+
+std::string matrixFileData(const Matrix<int>& m) {
+    std::ostringstream ss;
+    writeMatrix(ss, m);
+    return ss.str();
+}
+
+MatrixFileHeader& headerOf(std::string& data) {
+    return *reinterpret_cast<MatrixFileHeader*>(&data[0]);
+}
+
+} // unnamed namespace
+
+TEST(BitMatrix, getSet) {
+    for (std::size_t width : {1, 63, 64, 65, 130}) {
+        BitMatrix m = patternBits(width, 3);
+        EXPECT_EQ(m.wordsPerRow(), (width + 63) / 64);
+        for (Point p : PointRange{p00, Point(width, 3)}) {
+            EXPECT_EQ(pattern(p), m[p]) << width << " " << p;
+        }
+        EXPECT_EQ(countPattern(width, 3), m.count()) << width;
+        std::size_t row1 = 0;
+        for (int x = 0; x < static_cast<int>(width); ++x) {
+            row1 += pattern(Point(x, 1));
+        }
+        EXPECT_EQ(row1, m.countRow(1)) << width;
+    }
+}
+
+// count() counts the padding too, so it only matches if the padding is 0.
+TEST(BitMatrix, padding) {
+    for (std::size_t width : {63, 64, 65}) {
+        BitMatrix m{width, 2, true};
+        EXPECT_EQ(2 * width, m.count()) << width;
+        m.flip();
+        EXPECT_EQ(0u, m.count()) << width;
+        m.flip();
+        EXPECT_EQ(2 * width, m.count()) << width;
+        m.shiftX(-1);
+        EXPECT_EQ(2 * (width - 1), m.count()) << width;
+        m.shiftX(1);
+        EXPECT_EQ(2 * (width - 1), m.count()) << width;
+        EXPECT_FALSE(m[Point(0, 0)]);
+        EXPECT_TRUE(m[Point(width - 1, 1)]);
+        m.reset(width, 1, true);
+        EXPECT_EQ(width, m.count()) << width;
+    }
+}
+
+TEST(BitMatrix, shiftX) {
+    for (int width : {63, 64, 65, 130}) {
+        for (int n : {1, 5, 63, 64, 65, 129, 200, -1, -5, -63, -64, -65,
+                -129}) {
+            BitMatrix m = patternBits(width, 2);
+            m.shiftX(n);
+            std::size_t expectedCount = 0;
+            for (Point p : PointRange{p00, Point(width, 2)}) {
+                Point from = p - Point(n, 0);
+                bool expected = from.x >= 0 && from.x < width &&
+                        pattern(from);
+                EXPECT_EQ(expected, m[p]) << width << " " << n << " " << p;
+                expectedCount += expected;
+            }
+            EXPECT_EQ(expectedCount, m.count()) << width << " " << n;
+        }
+    }
+}
+
+TEST(BitMatrix, shiftY) {
+    for (int n : {1, 2, 4, 5, -1, -2, -4, -5}) {
+        BitMatrix m = patternBits(65, 4);
+        m.shiftY(n);
+        for (Point p : PointRange{p00, Point(65, 4)}) {
+            Point from = p - Point(0, n);
+            bool expected = from.y >= 0 && from.y < 4 && pattern(from);
+            EXPECT_EQ(expected, m[p]) << n << " " << p;
+        }
+    }
+}
+
+TEST(BitMatrix, operators) {
+    BitMatrix a = patternBits(65, 3);
+    BitMatrix b{65, 3};
+    for (Point p : PointRange{p00, Point(65, 3)}) {
+        b[p] = p.x % 2 == 0;
+    }
+    BitMatrix both = a, either = a, different = a;
+    both &= b;
+    either |= b;
+    different ^= b;
+    for (Point p : PointRange{p00, Point(65, 3)}) {
+        EXPECT_EQ(a[p] && b[p], both[p]) << p;
+        EXPECT_EQ(a[p] || b[p], either[p]) << p;
+        EXPECT_EQ(a[p] != b[p], different[p]) << p;
+    }
+    EXPECT_EQ(a, patternBits(65, 3));
+    EXPECT_NE(a, b);
+    EXPECT_EQ(std::hash<BitMatrix>{}(a),
+              std::hash<BitMatrix>{}(patternBits(65, 3)));
+}
+
+TEST(NibbleMatrix, getSet) {
+    for (std::size_t width : {1, 2, 7, 8}) {
+        NibbleMatrix m{width, 3};
+        EXPECT_EQ((width * 3 + 1) / 2, m.bytes().size());
+        for (Point p : PointRange{p00, Point(width, 3)}) {
+            m[p] = (p.x * 5 + p.y * 3) % 16;
+        }
+        for (Point p : PointRange{p00, Point(width, 3)}) {
+            EXPECT_EQ((p.x * 5 + p.y * 3) % 16, m[p]) << width << " " << p;
+        }
+        // Changing a cell leaves the other half of its byte alone.
+        for (std::size_t i = 0; i < m.size(); ++i) {
+            NibbleMatrix copy = m;
+            copy[i] = 15 - copy[i];
+            for (std::size_t j = 0; j < m.size(); ++j) {
+                EXPECT_EQ(j == i ? 15 - m[j] : m[j], copy[j]) <<
+                        width << " " << i << " " << j;
+            }
+        }
+    }
+}
+
+TEST(NibbleMatrix, fill) {
+    NibbleMatrix m{7, 3, 9};
+    for (std::size_t i = 0; i < m.size(); ++i) {
+        EXPECT_EQ(9, m[i]);
+    }
+    // The unused half of the last byte stays 0.
+    EXPECT_EQ(9, m.bytes().back());
+    m.fill(15);
+    EXPECT_EQ(15, m.bytes().back());
+    EXPECT_EQ(m, NibbleMatrix(7, 3, 15));
+    m[Point(6, 2)] = 0;
+    EXPECT_NE(m, NibbleMatrix(7, 3, 15));
+    ++m[Point(6, 2)];
+    --m[Point(5, 2)];
+    EXPECT_EQ(1, m[Point(6, 2)]);
+    EXPECT_EQ(14, m[Point(5, 2)]);
+    EXPECT_EQ(15, m[Point(4, 2)]);
+    m.reset(3, 3, 1);
+    EXPECT_EQ(5u, m.bytes().size());
+    EXPECT_EQ(1, m.bytes().back());
+}
+
+TEST(loadMatrix, numbers) {
+    std::istringstream ss{"1 2 3\n4  5\n\n7\n"};
+    Matrix<int> m = loadMatrix(ss, -1);
+    ASSERT_EQ(3u, m.width());
+    ASSERT_EQ(2u, m.height());
+    EXPECT_EQ((std::vector<int>{1, 2, 3, 4, 5, -1}),
+              std::vector<int>(m.begin(), m.end()));
+}
+
+TEST(loadMatrix, blankLines) {
+    std::istringstream blank{"   \n \t\n"};
+    Matrix<int> m = loadMatrix(blank, -1);
+    EXPECT_EQ(0u, m.width());
+    EXPECT_EQ(2u, m.height());
+
+    std::istringstream middle{"1 2\n  \n3 4\n"};
+    m = loadMatrix(middle, -1);
+    ASSERT_EQ(2u, m.width());
+    ASSERT_EQ(3u, m.height());
+    EXPECT_EQ((std::vector<int>{1, 2, -1, -1, 3, 4}),
+              std::vector<int>(m.begin(), m.end()));
+}
+
+TEST(loadMatrix, characters) {
+    std::istringstream ss{"#..\n#\n"};
+    Matrix<char> m = loadMatrix(ss, '#', 0, 0, true);
+    ASSERT_EQ(3u, m.width());
+    ASSERT_EQ(2u, m.height());
+    // The first line is the bottom row.
+    EXPECT_EQ("####..", std::string(m.begin(), m.end()));
+}
+
+TEST(MatrixFile, roundTrip) {
+    auto m = numberedMatrix<int>(7, 5);
+    std::stringstream ss;
+    writeMatrix(ss, m);
+    writeMatrix(ss, numberedMatrix<char>(3, 2));
+    writeMatrix(ss, Matrix<int>{});
+    EXPECT_EQ(m, readMatrix<int>(ss));
+    EXPECT_EQ((numberedMatrix<char>(3, 2)), readMatrix<char>(ss));
+    EXPECT_EQ(Matrix<int>{}, readMatrix<int>(ss));
+
+    using Tiled = TiledLayout<4>;
+    auto tiled = numberedMatrix<std::uint16_t, Tiled>(9, 6);
+    std::stringstream tiledStream;
+    writeMatrix(tiledStream, tiled);
+    EXPECT_EQ(tiled, (readMatrix<std::uint16_t, Tiled>(tiledStream)));
+}
+
+TEST(MatrixFile, pipe) {
+    auto m = numberedMatrix<int>(7, 5);
+    std::stringstream ss;
+    writeMatrix(ss, m);
+    writeMatrix(ss, Matrix<int>{});
+    PipeBuffer pipeBuffer{ss.str()};
+    std::istream pipe{&pipeBuffer};
+    EXPECT_EQ(m, readMatrix<int>(pipe));
+    EXPECT_EQ(Matrix<int>{}, readMatrix<int>(pipe));
+}
+
+TEST(MatrixFile, file) {
+    char fileName[] = "/tmp/util_matrixXXXXXX";
+    int fd = mkstemp(fileName);
+    ASSERT_NE(-1, fd);
+    close(fd);
+    Matrix<Point> m{6, 4};
+    for (Point p : matrixRange(m)) {
+        m[p] = p;
+    }
+    saveMatrixFile(fileName, m);
+    EXPECT_EQ(m, loadMatrixFile<Point>(fileName));
+    MappedMatrix<Point> mapped{fileName};
+    EXPECT_EQ(6u, mapped.width());
+    EXPECT_EQ(m[Point(5, 3)], mapped[Point(5, 3)]);
+    EXPECT_THROW(loadMatrixFile<int>(fileName), MatrixFileError);
+
+    // Truncated
+    std::string data = matrixFileData(numberedMatrix<int>(6, 4));
+    data.resize(data.size() - 1);
+    std::ofstream{fileName, std::ios::binary} << data;
+    EXPECT_THROW(loadMatrixFile<int>(fileName), MatrixFileError);
+    std::ofstream{fileName, std::ios::binary} << data.substr(0, 10);
+    EXPECT_THROW(loadMatrixFile<int>(fileName), MatrixFileError);
+    unlink(fileName);
+}
+
+TEST(MatrixFile, badHeader) {
+    std::string good = matrixFileData(numberedMatrix<int>(3, 2));
+
+    std::string data = good;
+    data[0] = 'X';
+    expectReadError<int>(data, "Not a matrix file.");
+
+    data = good;
+    headerOf(data).byteOrder = 0x04030201;
+    expectReadError<int>(data, "Matrix file has a different byte order.");
+
+    data = good;
+    headerOf(data).version = 2;
+    expectReadError<int>(data, "Unsupported matrix file version 2.");
+
+    expectReadError<unsigned>(good,
+            "Matrix file has a different element type.");
+    expectReadError<int, TiledLayout<4>>(good,
+            "Matrix file has a different layout.");
+}
+
+TEST(MatrixFile, truncated) {
+    std::string good = matrixFileData(numberedMatrix<int>(3, 2));
+    expectReadError<int>(good.substr(0, 63), "Matrix file is too short.");
+    expectReadError<int>(good.substr(0, good.size() - 1),
+            "Matrix file is too short.");
+
+    // Found before the cells are allocated: from the size of the stream, or
+    // from reading the pipe in growing chunks.
+    std::string data = good;
+    headerOf(data).width = std::uint64_t{1} << 40;
+    expectReadError<int>(data, "Matrix file is too short.");
+}
+
+// width * height * 4 is 2^66, which wraps around to 0.
+TEST(MatrixFile, overflow) {
+    std::string data = matrixFileData(Matrix<int>{});
+    headerOf(data).width = std::uint64_t{1} << 32;
+    headerOf(data).height = std::uint64_t{1} << 32;
+    expectReadError<int>(data, "Matrix file is too short.");
+    EXPECT_THROW(detail::matrixDataSize(headerOf(data)), MatrixFileError);
+    headerOf(data).height = 0;
+    EXPECT_EQ(0u, detail::matrixDataSize(headerOf(data)));
+}
+
+TEST(renderMatrix, integers) {
+    DumpOptions options;
+    options.colour = false;
+    EXPECT_EQ(" 3 3\n 3 3\n\n",
+              renderMatrix(Matrix<unsigned>{2, 2, 3u}, options));
+
+    Matrix<std::size_t> sizes{2, 1, 7};
+    sizes[Point(1, 0)] = std::numeric_limits<std::size_t>::max();
+    EXPECT_EQ("                    7 18446744073709551615\n\n",
+              renderMatrix(sizes, options));
+
+    Matrix<int> ints{3, 1, 0};
+    ints[Point(0, 0)] = -10;
+    ints[Point(2, 0)] = std::numeric_limits<int>::min();
+    EXPECT_EQ("         -10           0 -2147483648\n\n",
+              renderMatrix(ints, options));
+}
+
+namespace {
+
+// Cells without operator< that dumpMatrix() can only show with a converter.
+struct Label {
+    char name;
+};
+
+struct LabelToString {
+    std::string operator()(const Label& label) const {
+        return std::string{label.name};
+    }
+};
+
+} // unnamed namespace
+
+TEST(renderMatrix, notComparable) {
+    Matrix<Label> labels{4, 2, Label{'a'}};
+    labels[Point(1, 0)] = Label{'b'};
+    labels[Point(2, 1)] = Label{'c'};
+    DumpOptions options;
+    options.colour = false;
+    EXPECT_EQ(" a b a a\n a a c a\n\n",
+              renderMatrix(labels, options, LabelToString{}));
+    // The blocks show their first cells.
+    options.maxWidth = 2;
+    EXPECT_EQ("(2x1 blocks)\n a a\n a c\n\n",
+              renderMatrix(labels, options, LabelToString{}));
+
+    std::ostringstream ss;
+    dumpMatrix(ss, labels, "", {}, LabelToString{});
+    EXPECT_NE(std::string::npos, ss.str().find('c'));
+}
+
+TEST(dumpMatrix, unsigned) {
+    std::ostringstream ss;
+    dumpMatrix(ss, Matrix<unsigned>{2, 2, 3u});
+    dumpMatrix(ss, Matrix<std::size_t>{2, 2, 12});
+    EXPECT_NE(std::string::npos, ss.str().find(" 3"));
+    EXPECT_NE(std::string::npos, ss.str().find(" 12"));
+}
+
+TEST(PointRange, index) {
+    PointRange range{Point(2, 3), Point(5, 5)};
+    EXPECT_EQ(Point(2, 3), range[0]);
+    EXPECT_EQ(Point(4, 3), range[2]);
+    EXPECT_EQ(Point(3, 4), range[4]);
+    EXPECT_THROW(PointRange(Point(2, 3), Point(2, 5))[0], std::out_of_range);
+}
+
+TEST(parallelForEach, exception) {
+    PointRange range{p00, Point(7, 9)};
+    Matrix<int> visits{7, 9, 0};
+    parallelForEach(range, [&](Point p) { ++visits[p]; }, 4);
+    for (Point p : range) {
+        EXPECT_EQ(1, visits[p]) << p;
+    }
+    EXPECT_THROW(parallelForEach(range, [](Point p) {
+                if (p == Point(3, 8)) {
+                    throw std::runtime_error{"error"};
+                }
+            }, 4), std::runtime_error);
+}
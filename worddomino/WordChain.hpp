@@ -0,0 +1,36 @@
+#ifndef WORDDOMINO_WORDCHAIN_HPP
+#define WORDDOMINO_WORDCHAIN_HPP
+
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <vector>
+
+std::vector<std::string> readWords(std::istream& inputStream);
+
+struct Match {
+    Match(std::size_t firstWord, std::size_t secondWord, int matchSize)
+            : firstWord(firstWord),
+              secondWord(secondWord),
+              matchSize(matchSize) {
+    }
+
+    bool operator<(const Match& rhs) {
+        return firstWord < rhs.firstWord;
+    }
+
+    std::size_t firstWord;
+    std::size_t secondWord;
+    int matchSize;
+};
+
+std::vector<Match> matchWords(const std::vector<std::string>& words,
+        bool verbose);
+
+void validateMatches(const std::vector<std::string>& words,
+        const std::vector<Match>& matches);
+
+std::vector<Match> generateWordChain(const std::vector<Match>& matches,
+        int numberOfWords);
+
+#endif // WORDDOMINO_WORDCHAIN_HPP